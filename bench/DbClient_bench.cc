@@ -0,0 +1,193 @@
+#include <benchmark/benchmark.h>
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace drogon::orm;
+
+// Database round trips as the handlers make them. These need the database
+// from config.json, with at least one person in it, and are skipped when it
+// cannot be reached.
+namespace {
+constexpr size_t ioThreads = 16;
+constexpr size_t queriesPerLoop = 200;
+constexpr size_t inFlightPerLoop = 4;
+
+const char *getOneSql = "select person.*, \n\
+                   job.title as job_title, \n\
+                   department.name as department_name, \n\
+                   concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n\
+                   from person \n\
+                   join job on person.job_id =job.id \n\
+                   join department on person.department_id=department.id \n\
+                   join person as manager on person.manager_id = manager.id \n\
+                   where person.id = $1";
+
+std::thread appThread;
+
+auto startApp() -> bool {
+    static bool started = [] {
+        auto &app = drogon::app();
+        app.setThreadNum(ioThreads).setLogLevel(trantor::Logger::kWarn);
+        // a shared pool per IO thread count, as many connections as loops
+        for (auto threads : {1, 4, 16}) {
+            app.createDbClient("postgresql", "localhost", 5432, "org_chart", "postgres", "1234", threads, "",
+                               "shared_" + std::to_string(threads), false, "", -1.0);
+        }
+        app.createDbClient("postgresql", "localhost", 5432, "org_chart", "postgres", "1234", 1, "", "fast", true, "", -1.0);
+        appThread = std::thread([] { drogon::app().run(); });
+        std::atexit([] {
+            drogon::app().quit();
+            appThread.join();
+        });
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!drogon::app().isRunning() || !drogon::app().areAllDbClientsAvailable()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }();
+    return started;
+}
+
+struct Run {
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t pendingLoops;
+    std::vector<double> latencies;
+};
+
+// keeps inFlightPerLoop queries going from one IO loop until queriesPerLoop
+// answers are back on that loop
+struct LoopDriver : std::enable_shared_from_this<LoopDriver> {
+    trantor::EventLoop *loop;
+    DbClientPtr client;
+    std::shared_ptr<Run> run;
+    size_t sent{0};
+    std::vector<double> latencies;
+
+    void send() {
+        ++sent;
+        auto self = shared_from_this();
+        auto start = std::chrono::steady_clock::now();
+        auto onReply = [self, start]() {
+            self->loop->runInLoop([self, start]() { self->received(start); });
+        };
+        client->execSqlAsync(
+            getOneSql,
+            [onReply](const Result &) { onReply(); },
+            [onReply](const DrogonDbException &e) {
+                LOG_ERROR << e.base().what();
+                onReply();
+            },
+            1);
+    }
+
+    void received(std::chrono::steady_clock::time_point start) {
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        if (sent < queriesPerLoop) {
+            send();
+            return;
+        }
+        if (latencies.size() == queriesPerLoop) {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->latencies.insert(run->latencies.end(), latencies.begin(), latencies.end());
+            if (--run->pendingLoops == 0) {
+                run->done.notify_one();
+            }
+        }
+    }
+};
+}  // namespace
+
+// p50/p99 latency of the /persons/{id} query when the IO loops share one
+// pool (answers come back on the pool's threads and are handed back to the
+// loop) versus a fast client per loop (sent and answered on the loop)
+static void BM_GetPersonLatency(benchmark::State &state) {
+    auto fast = state.range(0) != 0;
+    auto threads = static_cast<size_t>(state.range(1));
+    if (!startApp()) {
+        state.SkipWithError("cannot reach the database from config.json");
+        return;
+    }
+
+    std::vector<double> latencies;
+    for (auto _ : state) {
+        auto run = std::make_shared<Run>();
+        run->pendingLoops = threads;
+        for (size_t i = 0; i < threads; ++i) {
+            auto *loop = drogon::app().getIOLoop(i);
+            loop->queueInLoop([loop, run, fast, threads]() {
+                auto driver = std::make_shared<LoopDriver>();
+                driver->loop = loop;
+                driver->client = fast ? drogon::app().getFastDbClient("fast")
+                                      : drogon::app().getDbClient("shared_" + std::to_string(threads));
+                driver->run = run;
+                for (size_t q = 0; q < inFlightPerLoop; ++q) {
+                    driver->send();
+                }
+            });
+        }
+        std::unique_lock<std::mutex> lock(run->mutex);
+        run->done.wait(lock, [&run]() { return run->pendingLoops == 0; });
+        latencies.insert(latencies.end(), run->latencies.begin(), run->latencies.end());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_us"] = latencies[latencies.size() / 2];
+    state.counters["p99_us"] = latencies[latencies.size() * 99 / 100];
+    state.SetItemsProcessed(static_cast<int64_t>(latencies.size()));
+}
+BENCHMARK(BM_GetPersonLatency)
+    ->ArgNames({"fast", "io_threads"})
+    ->ArgsProduct({{0, 1}, {1, 4, 16}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// AuthController::registerUser used to look the username up and then insert;
+// it now does both in one statement. Same work, one round trip fewer.
+static void BM_RegisterUser(benchmark::State &state) {
+    auto combined = state.range(0) != 0;
+    if (!startApp()) {
+        state.SkipWithError("cannot reach the database from config.json");
+        return;
+    }
+
+    auto client = drogon::app().getDbClient("shared_1");
+    size_t n = 0;
+    size_t roundTrips = 0;
+    for (auto _ : state) {
+        auto username = "bench-register-" + std::to_string(n);
+        // users.password is unique too
+        auto hash = "$2a$10$benchmarkbenchmarkbenchmarkbenchmarkbenchmarkbench" + std::to_string(n++);
+        if (combined) {
+            client->execSqlSync("insert into users (username, password) \n\
+                                 values ($1, $2) \n\
+                                 on conflict (username) do nothing \n\
+                                 returning *",
+                                username,
+                                hash);
+            ++roundTrips;
+        } else {
+            auto found = client->execSqlSync("select * from users where username = $1", username);
+            ++roundTrips;
+            if (found.empty()) {
+                client->execSqlSync("insert into users (username, password) values ($1, $2) returning *", username, hash);
+                ++roundTrips;
+            }
+        }
+    }
+    client->execSqlSync("delete from users where username like 'bench-register-%'");
+    state.counters["round_trips"] = benchmark::Counter(static_cast<double>(roundTrips), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RegisterUser)->ArgName("one_statement")->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMicrosecond);
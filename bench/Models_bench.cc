@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include "../models/Person.h"
+#include "../models/PersonInfo.h"
+#include "../test/InMemoryResult.h"
+
+using namespace drogon_model::org_chart;
+
+namespace {
+constexpr size_t rowCount = 1000;
+
+std::vector<std::string> text;
+
+// rowCount rows of the /persons list query, person.* first
+auto personRows() -> drogon::orm::Result {
+    text.clear();
+    text.reserve(rowCount * 3);
+    for (size_t i = 0; i < rowCount; ++i) {
+        text.push_back(std::to_string(i + 1));
+        // long enough to leave the small string buffer
+        text.push_back("Firstname-with-some-length-" + std::to_string(i));
+        text.push_back("Lastname-with-some-length-" + std::to_string(i));
+    }
+    InMemoryResult::Rows values;
+    for (size_t i = 0; i < rowCount; ++i) {
+        const auto *t = &text[i * 3];
+        values.push_back({t[0].c_str(), "2", "3", "1", t[1].c_str(), t[2].c_str(), nullptr, "Senior Software Engineer",
+                          "Platform Engineering", "Grace Hopper"});
+    }
+    return InMemoryResult::make({"id", "job_id", "department_id", "manager_id", "first_name", "last_name", "hire_date",
+                                 "job_title", "department_name", "manager_full_name"},
+                                std::move(values));
+}
+}  // namespace
+
+// rows decoded into models, as the handlers and OrgGraphPlugin::reload do
+static void BM_DecodePersons(benchmark::State &state) {
+    auto result = personRows();
+    for (auto _ : state) {
+        std::vector<Person> persons;
+        persons.reserve(result.size());
+        for (auto row : result) {
+            persons.emplace_back(row);
+        }
+        benchmark::DoNotOptimize(persons.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(result.size()));
+}
+BENCHMARK(BM_DecodePersons);
+
+static void BM_DecodePersonInfos(benchmark::State &state) {
+    auto result = personRows();
+    for (auto _ : state) {
+        std::vector<PersonInfo> infos;
+        infos.reserve(result.size());
+        for (auto row : result) {
+            infos.emplace_back(row);
+        }
+        benchmark::DoNotOptimize(infos.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(result.size()));
+}
+BENCHMARK(BM_DecodePersonInfos);
+
+// PersonInfo read by column name for every field of every row, against the
+// positions looked up once for the whole result
+static void BM_DecodePersonInfos_ByName(benchmark::State &state) {
+    auto result = personRows();
+    for (auto _ : state) {
+        std::vector<PersonInfo> infos;
+        infos.reserve(result.size());
+        for (auto row : result) {
+            infos.emplace_back(row, -1);
+        }
+        benchmark::DoNotOptimize(infos.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(result.size()));
+}
+BENCHMARK(BM_DecodePersonInfos_ByName);
+
+static void BM_DecodePersonInfos_BoundColumns(benchmark::State &state) {
+    auto result = personRows();
+    for (auto _ : state) {
+        auto columns = PersonInfo::columnsOf(result);
+        std::vector<PersonInfo> infos;
+        infos.reserve(result.size());
+        for (auto row : result) {
+            infos.emplace_back(row, columns);
+        }
+        benchmark::DoNotOptimize(infos.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(result.size()));
+}
+BENCHMARK(BM_DecodePersonInfos_BoundColumns);
+
+// a by-value copy of every model, as `for (auto p : persons)` makes
+static void BM_CopyPersons(benchmark::State &state) {
+    auto result = personRows();
+    std::vector<Person> persons;
+    for (auto row : result) {
+        persons.emplace_back(row);
+    }
+    for (auto _ : state) {
+        auto copy = persons;
+        benchmark::DoNotOptimize(copy.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(persons.size()));
+}
+BENCHMARK(BM_CopyPersons);
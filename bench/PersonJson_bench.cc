@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include "../models/PersonInfo.h"
+#include "../test/InMemoryResult.h"
+#include "../utils/PersonJson.h"
+#include "../utils/utils.h"
+
+using namespace drogon_model::org_chart;
+
+namespace {
+// a page of the /persons list query, as text the way libpq returns it
+auto personsPage(size_t rows) -> drogon::orm::Result {
+    static std::vector<std::string> text;
+    text.clear();
+    text.reserve(rows * 4);
+    for (size_t i = 0; i < rows; ++i) {
+        text.push_back(std::to_string(i + 1));
+        text.push_back("First" + std::to_string(i));
+        text.push_back("Lastname-" + std::to_string(i));
+        text.push_back(std::to_string(1 + i % 40));
+    }
+    InMemoryResult::Rows values;
+    for (size_t i = 0; i < rows; ++i) {
+        const auto *t = &text[i * 4];
+        values.push_back({t[0].c_str(), t[3].c_str(), t[3].c_str(), "1", t[1].c_str(), t[2].c_str(), "2019-04-15",
+                          "Senior Software Engineer", "Platform Engineering", "Grace Hopper"});
+    }
+    return InMemoryResult::make({"id", "job_id", "department_id", "manager_id", "first_name", "last_name", "hire_date",
+                                 "job_title", "department_name", "manager_full_name"},
+                                std::move(values));
+}
+}  // namespace
+
+// what the /persons list handlers did per page: PersonInfo and a
+// PersonDetails-shaped Json::Value per row, serialized as one array
+static void BM_PersonsPageJson_ValueTree(benchmark::State &state) {
+    auto result = personsPage(static_cast<size_t>(state.range(0)));
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    for (auto _ : state) {
+        Json::Value ret{};
+        for (auto row : result) {
+            PersonInfo info{row};
+            Json::Value details;
+            details["id"] = info.getValueOfId();
+            details["first_name"] = info.getValueOfFirstName();
+            details["last_name"] = info.getValueOfLastName();
+            details["hire_date"] = info.getValueOfHireDate().toDbStringLocal();
+            Json::Value manager;
+            manager["id"] = info.getValueOfManagerId();
+            manager["full_name"] = info.getValueOfManagerFullName();
+            details["manager"] = manager;
+            Json::Value department;
+            department["id"] = info.getValueOfDepartmentId();
+            department["name"] = info.getValueOfDepartmentName();
+            details["department"] = department;
+            Json::Value job;
+            job["id"] = info.getValueOfJobId();
+            job["title"] = info.getValueOfJobTitle();
+            details["job"] = job;
+            details["headcount"] = Json::Value(static_cast<Json::Int64>(3));
+            ret.append(details);
+        }
+        auto body = Json::writeString(builder, ret);
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PersonsPageJson_ValueTree)->Arg(100)->Arg(1000);
+
+static void BM_PersonsPageJson_Writer(benchmark::State &state) {
+    auto result = personsPage(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        PersonJsonWriter writer{result};
+        std::string body;
+        body.reserve(result.size() * 256);
+        for (auto row : result) {
+            writer.appendElement(body, row, 3);
+        }
+        body += ']';
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PersonsPageJson_Writer)->Arg(100)->Arg(1000);
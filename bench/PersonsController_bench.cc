@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+#include <regex>
+#include <string>
+#include "../controllers/PersonsController.h"
+
+namespace {
+const char *listTemplate = "select person.*, \n\
+                   job.title as job_title, \n\
+                   department.name as department_name, \n\
+                   concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n\
+                   from person \n\
+                   join job on person.job_id =job.id \n\
+                   join department on person.department_id=department.id \n\
+                   join person as manager on person.manager_id = manager.id \n\
+                   order by $sort_field $sort_order \n\
+                   limit $1 offset $2;";
+}  // namespace
+
+// what PersonsController::get used to do for every request
+static void BM_PersonsListSql_RegexTemplate(benchmark::State &state) {
+    std::string field = "last_name";
+    std::string order = "desc";
+    for (auto _ : state) {
+        auto sql = std::regex_replace(listTemplate, std::regex("\\$sort_field"), field);
+        sql = std::regex_replace(sql, std::regex("\\$sort_order"), order);
+        benchmark::DoNotOptimize(sql);
+    }
+}
+BENCHMARK(BM_PersonsListSql_RegexTemplate);
+
+static void BM_PersonsListSql_StatementTable(benchmark::State &state) {
+    std::string field = "last_name";
+    std::string order = "desc";
+    for (auto _ : state) {
+        const auto *sql = PersonsController::listSql(field, order);
+        benchmark::DoNotOptimize(sql);
+    }
+}
+BENCHMARK(BM_PersonsListSql_StatementTable);
@@ -1,6 +1,7 @@
 #include <libbcrypt/include/bcrypt/BCrypt.hpp>
 #include "AuthController.h"
 #include "../plugins/JwtPlugin.h"
+#include "../plugins/DbRouterPlugin.h"
 
 using namespace drogon::orm;
 using namespace drogon_model::org_chart;
@@ -17,104 +18,108 @@ namespace drogon {
 
 void AuthController::registerUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const {
     LOG_DEBUG << "registerUser";
-    try {
-        auto dbClientPtr = drogon::app().getDbClient();
-        Mapper<User> mp(dbClientPtr);
-
-        if (!areFieldsValid(pUser)) {
-            Json::Value ret{};
-            ret["error"] = "missing fields";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
-        }
-
-        if (!isUserAvailable(pUser, mp)) {
-            Json::Value ret{};
-            ret["error"] = "username is taken";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
-        }
-
-        auto newUser = pUser;
-        newUser.setPassword(BCrypt::generateHash(newUser.getValueOfPassword()));
-        mp.insertFuture(newUser).get();
-
-        auto userWithToken = AuthController::UserWithToken(newUser);
-        Json::Value ret = userWithToken.toJson();
+    if (!areFieldsValid(pUser)) {
+        Json::Value ret{};
+        ret["error"] = "missing fields";
         auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k201Created);
+        resp->setStatusCode(HttpStatusCode::k400BadRequest);
         callback(resp);
-    } catch (const DrogonDbException & e) {
+        return;
+    }
+
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
+    auto onError = [callbackPtr](const DrogonDbException &e) {
         LOG_ERROR << e.base().what();
         Json::Value ret{};
         ret["error"] = "database error";
         auto resp = HttpResponse::newHttpJsonResponse(ret);
         resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-        callback(resp);
-    }
+        (*callbackPtr)(resp);
+    };
+
+    // the availability check and the insert in one round trip; the unique
+    // index decides, so concurrent registrations of one name cannot both pass
+    *dbClientPtr << "insert into users (username, password) \n\
+                     values ($1, $2) \n\
+                     on conflict (username) do nothing \n\
+                     returning *"
+                 << pUser.getValueOfUsername()
+                 << BCrypt::generateHash(pUser.getValueOfPassword())
+                 >> [callbackPtr](const Result &result)
+                   {
+                      if (result.empty()) {
+                          Json::Value ret{};
+                          ret["error"] = "username is taken";
+                          auto resp = HttpResponse::newHttpJsonResponse(ret);
+                          resp->setStatusCode(HttpStatusCode::k400BadRequest);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+
+                      auto userWithToken = AuthController::UserWithToken(User(result[0]));
+                      Json::Value ret = userWithToken.toJson();
+                      auto resp = HttpResponse::newHttpJsonResponse(ret);
+                      resp->setStatusCode(HttpStatusCode::k201Created);
+                      (*callbackPtr)(resp);
+                   }
+                 >> onError;
 }
 
 void AuthController::loginUser(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, User &&pUser) const {
     LOG_DEBUG << "loginUser";
-    try {
-        auto dbClientPtr = drogon::app().getDbClient();
-        Mapper<User> mp(dbClientPtr);
-
-        if (!areFieldsValid(pUser)) {
-            Json::Value ret{};
-            ret["error"] = "missing fields";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
-        }
-
-        auto user = mp.findFutureBy(Criteria(User::Cols::_username, CompareOperator::EQ, pUser.getValueOfUsername())).get();
-        if (user.empty()) {
-            Json::Value ret{};
-            ret["error"] = "user not found";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k400BadRequest);
-            callback(resp);
-            return;
-        }
-
-        if (!isPasswordValid(pUser.getValueOfPassword(), user[0].getValueOfPassword())) {
-            Json::Value ret{};
-            ret["error"] = "username and password do not match";
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k401Unauthorized);
-            callback(resp);
-            return;
-        }
-
-        auto userWithToken = AuthController::UserWithToken(user[0]);
-        auto ret = userWithToken.toJson();
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        callback(resp);
-    } catch (const DrogonDbException & e) {
-        LOG_ERROR << e.base().what();
+    if (!areFieldsValid(pUser)) {
         Json::Value ret{};
-        ret["error"] = "database error";
+        ret["error"] = "missing fields";
         auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+        resp->setStatusCode(HttpStatusCode::k400BadRequest);
         callback(resp);
+        return;
     }
+
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
+    Mapper<User> mp(dbClientPtr);
+    mp.findBy(
+        Criteria(User::Cols::_username, CompareOperator::EQ, pUser.getValueOfUsername()),
+        [this, callbackPtr, pUser](const std::vector<User> &user) {
+            if (user.empty()) {
+                Json::Value ret{};
+                ret["error"] = "user not found";
+                auto resp = HttpResponse::newHttpJsonResponse(ret);
+                resp->setStatusCode(HttpStatusCode::k400BadRequest);
+                (*callbackPtr)(resp);
+                return;
+            }
+
+            if (!isPasswordValid(pUser.getValueOfPassword(), user[0].getValueOfPassword())) {
+                Json::Value ret{};
+                ret["error"] = "username and password do not match";
+                auto resp = HttpResponse::newHttpJsonResponse(ret);
+                resp->setStatusCode(HttpStatusCode::k401Unauthorized);
+                (*callbackPtr)(resp);
+                return;
+            }
+
+            auto userWithToken = AuthController::UserWithToken(user[0]);
+            auto ret = userWithToken.toJson();
+            auto resp = HttpResponse::newHttpJsonResponse(ret);
+            (*callbackPtr)(resp);
+        },
+        [callbackPtr](const DrogonDbException &e) {
+            LOG_ERROR << e.base().what();
+            Json::Value ret{};
+            ret["error"] = "database error";
+            auto resp = HttpResponse::newHttpJsonResponse(ret);
+            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+            (*callbackPtr)(resp);
+        });
 }
 
 bool AuthController::areFieldsValid(const User &user) const {
     return user.getUsername() != nullptr && user.getPassword() != nullptr;
 }
 
-bool AuthController::isUserAvailable(const User &user, Mapper<User> &mp) const {
-    auto criteria = Criteria(User::Cols::_username, CompareOperator::EQ, user.getValueOfUsername());
-    return mp.findFutureBy(criteria).get().empty();
-}
-
 bool AuthController::isPasswordValid(const std::string &text, const std::string &hash) const {
     return BCrypt::validatePassword(text, hash);
 }
@@ -28,6 +28,5 @@ class AuthController : public drogon::HttpController<AuthController> {
     };
 
     bool areFieldsValid(const User &user) const;
-    bool isUserAvailable(const User &user, Mapper<User> &mp) const;
     bool isPasswordValid(const std::string &text, const std::string &hash) const;
 };
@@ -1,6 +1,9 @@
 #include "DepartmentsController.h"
 #include "../utils/utils.h"
 #include "../models/Person.h"
+#include "PersonsController.h"
+#include "../plugins/DbRouterPlugin.h"
+#include "../plugins/ResultCachePlugin.h"
 #include <string>
 #include <memory>
 #include <utility>
@@ -19,48 +22,151 @@ namespace drogon {
     }
 }  // namespace drogon
 
+namespace {
+// columns /departments can be sorted by
+const char *sortFields[] = {"id", "name"};
+
+auto isSortable(const std::string &sortField, const std::string &sortOrder) -> bool {
+    if (sortOrder != "asc" && sortOrder != "desc") {
+        return false;
+    }
+    for (const auto *field : sortFields) {
+        if (sortField == field) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the page after a cursor's (key, id); sortField must be whitelisted
+auto keysetSql(const std::string &sortField, const std::string &sortOrder) -> std::string {
+    auto cmp = sortOrder == "asc" ? " > " : " < ";
+    if (sortField == "id") {
+        return std::string("select * from department where id") + cmp + "$1 order by id " + sortOrder + " limit $2";
+    }
+    return "select * from department where (" + sortField + ", id)" + cmp + "($1, $2) order by " + sortField + " " +
+           sortOrder + ", id " + sortOrder + " limit $3";
+}
+}  // namespace
+
 void DepartmentsController::get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
     LOG_DEBUG << "get";
     auto offset = req->getOptionalParameter<int>("offset").value_or(0);
     auto limit = req->getOptionalParameter<int>("limit").value_or(25);
     auto sortField = req->getOptionalParameter<std::string>("sort_field").value_or("id");
     auto sortOrder = req->getOptionalParameter<std::string>("sort_order").value_or("asc");
+    auto cursorToken = req->getOptionalParameter<std::string>("cursor");
+
+    PageCursor cursor;
+    if (cursorToken) {
+        if (!decodeCursor(*cursorToken, cursor)) {
+            badRequest(std::move(callback), "invalid cursor");
+            return;
+        }
+        sortField = cursor.sortField;
+        sortOrder = cursor.sortOrder;
+    }
+    if (!isSortable(sortField, sortOrder)) {
+        badRequest(std::move(callback), "unsupported sort_field or sort_order");
+        return;
+    }
     auto sortOrderEnum = sortOrder == "asc" ? SortOrder::ASC : SortOrder::DESC;
 
+    auto *cachePtr = drogon::app().getPlugin<ResultCachePlugin>();
+    auto cacheKey = "list " + sortField + " " + sortOrder + " " + std::to_string(limit) + " " +
+                    (cursorToken ? "after " + *cursorToken : std::to_string(offset));
+    auto etag = cachePtr->etag({"department"}, "/departments " + cacheKey);
+    if (auto resp = ResultCachePlugin::notModified(req, etag)) {
+        callback(resp);
+        return;
+    }
+    if (auto cached = cachePtr->find("department", cacheKey)) {
+        callback(cached);
+        return;
+    }
+    auto version = cachePtr->version("department");
+    // a miss is filled from the primary, so the entry and tag hold every
+    // write version counts
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req, !etag.empty());
+
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-    Mapper<Department> mp(dbClientPtr);
-    mp.orderBy(sortField, sortOrderEnum).offset(offset).limit(limit).findAll(
-        [callbackPtr](const std::vector<Department> &departments) {
-            Json::Value ret{};
-            for (auto d : departments) {
-                ret.append(d.toJson());
-            }
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k200OK);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e) {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
-    });
+    auto respond = [callbackPtr, sortField, sortOrder, limit, cachePtr, cacheKey, version, etag](const std::vector<Department> &departments) {
+        Json::Value ret{Json::arrayValue};
+        for (const auto &d : departments) {
+            ret.append(d.toJson());
+        }
+        auto resp = HttpResponse::newHttpJsonResponse(ret);
+        resp->setStatusCode(HttpStatusCode::k200OK);
+        if (!departments.empty() && departments.size() == static_cast<size_t>(limit)) {
+            auto last = departments.back().toJson();
+            addNextCursor(resp, PageCursor{sortField, sortOrder, last[sortField].asString(), last["id"].asInt()});
+        }
+        if (!etag.empty()) {
+            resp->addHeader("ETag", etag);
+        }
+        cachePtr->store("department", cacheKey, version, resp);
+        (*callbackPtr)(resp);
+    };
+    auto onError = [callbackPtr](const DrogonDbException &e) {
+        LOG_ERROR << e.base().what();
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+        resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+        (*callbackPtr)(resp);
+    };
+
+    if (!cursorToken) {
+        Mapper<Department> mp(dbClientPtr);
+        mp.orderBy(sortField, sortOrderEnum).offset(offset).limit(limit).findAll(respond, onError);
+        return;
+    }
+
+    // keyset: seek straight past the previous page instead of skipping rows
+    auto binder = *dbClientPtr << keysetSql(sortField, sortOrder);
+    if (sortField != "id") {
+        binder << cursor.key;
+    }
+    binder << cursor.id << std::to_string(limit);
+    binder >> [respond](const Result &result) {
+               std::vector<Department> departments;
+               departments.reserve(result.size());
+               for (auto row : result) {
+                   departments.emplace_back(row);
+               }
+               respond(departments);
+           }
+           >> onError;
 }
 
 void DepartmentsController::getOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId) const {
     LOG_DEBUG << "getOne departmentId: "<< departmentId;
+    auto *cachePtr = drogon::app().getPlugin<ResultCachePlugin>();
+    auto cacheKey = "id " + std::to_string(departmentId);
+    auto etag = cachePtr->etag({"department"}, "/departments " + cacheKey);
+    if (auto resp = ResultCachePlugin::notModified(req, etag)) {
+        callback(resp);
+        return;
+    }
+    if (auto cached = cachePtr->find("department", cacheKey)) {
+        callback(cached);
+        return;
+    }
+    auto version = cachePtr->version("department");
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req, !etag.empty());
+
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
 
     Mapper<Department> mp(dbClientPtr);
     mp.findByPrimaryKey(
         departmentId,
-        [callbackPtr](const Department &department) {
+        [callbackPtr, cachePtr, cacheKey, version, etag](const Department &department) {
             Json::Value ret{};
             ret = department.toJson();
             auto resp = HttpResponse::newHttpJsonResponse(ret);
             resp->setStatusCode(HttpStatusCode::k201Created);
+            if (!etag.empty()) {
+                resp->addHeader("ETag", etag);
+            }
+            cachePtr->store("department", cacheKey, version, resp);
             (*callbackPtr)(resp);
         },
         [callbackPtr](const DrogonDbException &e) {
@@ -81,12 +187,13 @@ void DepartmentsController::getOne(const HttpRequestPtr &req, std::function<void
 void DepartmentsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Department &&pDepartment) const {
     LOG_DEBUG << "createOne";
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
 
     Mapper<Department> mp(dbClientPtr);
     mp.insert(
         pDepartment,
         [callbackPtr](const Department &department) {
+            drogon::app().getPlugin<ResultCachePlugin>()->invalidate("department");
             Json::Value ret{};
             ret = department.toJson();
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -103,53 +210,50 @@ void DepartmentsController::createOne(const HttpRequestPtr &req, std::function<v
 
 void DepartmentsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId, Department &&pDepartmentDetails) const {
     LOG_DEBUG << "updateOne departmentId: " << departmentId;
-    auto dbClientPtr = drogon::app().getDbClient();
-
-    // blocking IO
-    Mapper<Department> mp(dbClientPtr);
-    Department department;
-    try {
-        department = mp.findFutureByPrimaryKey(departmentId).get();
-    } catch (const DrogonDbException & e) {
-        Json::Value ret{};
-        ret["error"] = "resource not found";
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
-        callback(resp);
-    }
-
-    if (pDepartmentDetails.getName() != nullptr) {
-        department.setName(pDepartmentDetails.getValueOfName());
+    if (pDepartmentDetails.getName() == nullptr) {
+        badRequest(std::move(callback), "no fields to update");
+        return;
     }
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    mp.update(
-        department,
-        [callbackPtr](const std::size_t count)
-        {
-            auto resp = HttpResponse::newHttpResponse();
-            resp->setStatusCode(HttpStatusCode::k204NoContent);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e)
-        {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
-        }
-    );
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
+    *dbClientPtr << "update department set name = $2 where id = $1 returning *"
+                 << departmentId
+                 << pDepartmentDetails.getValueOfName()
+                 >> [callbackPtr](const Result &result)
+                   {
+                      if (result.empty()) {
+                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                          resp->setStatusCode(HttpStatusCode::k404NotFound);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+                      drogon::app().getPlugin<ResultCachePlugin>()->invalidate("department");
+                      auto resp = HttpResponse::newHttpResponse();
+                      resp->setStatusCode(HttpStatusCode::k204NoContent);
+                      (*callbackPtr)(resp);
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
 }
 
 void DepartmentsController::deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId) const {
     LOG_DEBUG << "deleteOne departmentId: ";
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
 
     Mapper<Department> mp(dbClientPtr);
     mp.deleteBy(
         Criteria(Department::Cols::_id, CompareOperator::EQ, departmentId),
         [callbackPtr](const std::size_t count) {
+            if (count > 0) {
+                drogon::app().getPlugin<ResultCachePlugin>()->invalidate("department");
+            }
             auto resp = HttpResponse::newHttpResponse();
             resp->setStatusCode(HttpStatusCode::k204NoContent);
             (*callbackPtr)(resp);
@@ -165,45 +269,20 @@ void DepartmentsController::deleteOne(const HttpRequestPtr &req, std::function<v
 void DepartmentsController::getDepartmentPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int departmentId) const {
     LOG_DEBUG << "getDepartmentPersons departmentId: "<< departmentId;
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-
-    // blocking IO
-    Mapper<Department> mp(dbClientPtr);
-    Department department;
-    try {
-        department = mp.findFutureByPrimaryKey(departmentId).get();
-    } catch (const DrogonDbException & e) {
-        Json::Value ret{};
-        ret["error"] = "resource not found";
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
-        callback(resp);
-    }
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
 
-    department.getPersons(dbClientPtr,
-      [callbackPtr](const std::vector<Person> persons) {
-          if (persons.empty()) {
-              Json::Value ret{};
-              ret["error"] = "resource not found";
-              auto resp = HttpResponse::newHttpJsonResponse(ret);
-              resp->setStatusCode(HttpStatusCode::k404NotFound);
-              (*callbackPtr)(resp);
-          } else {
-              Json::Value ret{};
-              for (auto p : persons) {
-                  ret.append(p.toJson());
-              }
-              auto resp = HttpResponse::newHttpJsonResponse(ret);
-              resp->setStatusCode(HttpStatusCode::k200OK);
-              (*callbackPtr)(resp);
-          }
-      },
-      [callbackPtr](const DrogonDbException &e) {
-          LOG_ERROR << e.base().what();
-          Json::Value ret{};
-          ret["error"] = "database error";
-          auto resp = HttpResponse::newHttpJsonResponse(ret);
-          resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-          (*callbackPtr)(resp);
-      });
+    static const auto sql = PersonsController::membersSql("department", "department_id");
+    *dbClientPtr << sql
+                 << departmentId
+                 >> [callbackPtr](const Result &result)
+                   {
+                      (*callbackPtr)(PersonsController::membersResponse(result));
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
 }
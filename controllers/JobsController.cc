@@ -1,6 +1,9 @@
 #include "JobsController.h"
 #include "../utils/utils.h"
 #include "../models/Person.h"
+#include "PersonsController.h"
+#include "../plugins/DbRouterPlugin.h"
+#include "../plugins/ResultCachePlugin.h"
 #include <string>
 #include <memory>
 #include <utility>
@@ -18,48 +21,151 @@ namespace drogon {
     }
 }
 
+namespace {
+// columns /jobs can be sorted by
+const char *sortFields[] = {"id", "title"};
+
+auto isSortable(const std::string &sortField, const std::string &sortOrder) -> bool {
+    if (sortOrder != "asc" && sortOrder != "desc") {
+        return false;
+    }
+    for (const auto *field : sortFields) {
+        if (sortField == field) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the page after a cursor's (key, id); sortField must be whitelisted
+auto keysetSql(const std::string &sortField, const std::string &sortOrder) -> std::string {
+    auto cmp = sortOrder == "asc" ? " > " : " < ";
+    if (sortField == "id") {
+        return std::string("select * from job where id") + cmp + "$1 order by id " + sortOrder + " limit $2";
+    }
+    return "select * from job where (" + sortField + ", id)" + cmp + "($1, $2) order by " + sortField + " " +
+           sortOrder + ", id " + sortOrder + " limit $3";
+}
+}  // namespace
+
 void JobsController::get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
     LOG_DEBUG << "get";
     auto offset = req->getOptionalParameter<int>("offset").value_or(0);
     auto limit = req->getOptionalParameter<int>("limit").value_or(25);
     auto sortField = req->getOptionalParameter<std::string>("sort_field").value_or("id");
     auto sortOrder = req->getOptionalParameter<std::string>("sort_order").value_or("asc");
+    auto cursorToken = req->getOptionalParameter<std::string>("cursor");
+
+    PageCursor cursor;
+    if (cursorToken) {
+        if (!decodeCursor(*cursorToken, cursor)) {
+            badRequest(std::move(callback), "invalid cursor");
+            return;
+        }
+        sortField = cursor.sortField;
+        sortOrder = cursor.sortOrder;
+    }
+    if (!isSortable(sortField, sortOrder)) {
+        badRequest(std::move(callback), "unsupported sort_field or sort_order");
+        return;
+    }
     auto sortOrderEnum = sortOrder == "asc" ? SortOrder::ASC : SortOrder::DESC;
 
+    auto *cachePtr = drogon::app().getPlugin<ResultCachePlugin>();
+    auto cacheKey = "list " + sortField + " " + sortOrder + " " + std::to_string(limit) + " " +
+                    (cursorToken ? "after " + *cursorToken : std::to_string(offset));
+    auto etag = cachePtr->etag({"job"}, "/jobs " + cacheKey);
+    if (auto resp = ResultCachePlugin::notModified(req, etag)) {
+        callback(resp);
+        return;
+    }
+    if (auto cached = cachePtr->find("job", cacheKey)) {
+        callback(cached);
+        return;
+    }
+    auto version = cachePtr->version("job");
+    // a miss is filled from the primary, so the entry and tag hold every
+    // write version counts
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req, !etag.empty());
+
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-    Mapper<Job> mp(dbClientPtr);
-    mp.orderBy(sortField, sortOrderEnum).offset(offset).limit(limit).findAll(
-        [callbackPtr](const std::vector<Job> &jobs) {
-            Json::Value ret{};
-            for (auto j : jobs) {
-                ret.append(j.toJson());
-            }
-            auto resp = HttpResponse::newHttpJsonResponse(ret);
-            resp->setStatusCode(HttpStatusCode::k200OK);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e) {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
-    });
+    auto respond = [callbackPtr, sortField, sortOrder, limit, cachePtr, cacheKey, version, etag](const std::vector<Job> &jobs) {
+        Json::Value ret{Json::arrayValue};
+        for (const auto &j : jobs) {
+            ret.append(j.toJson());
+        }
+        auto resp = HttpResponse::newHttpJsonResponse(ret);
+        resp->setStatusCode(HttpStatusCode::k200OK);
+        if (!jobs.empty() && jobs.size() == static_cast<size_t>(limit)) {
+            auto last = jobs.back().toJson();
+            addNextCursor(resp, PageCursor{sortField, sortOrder, last[sortField].asString(), last["id"].asInt()});
+        }
+        if (!etag.empty()) {
+            resp->addHeader("ETag", etag);
+        }
+        cachePtr->store("job", cacheKey, version, resp);
+        (*callbackPtr)(resp);
+    };
+    auto onError = [callbackPtr](const DrogonDbException &e) {
+        LOG_ERROR << e.base().what();
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+        resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+        (*callbackPtr)(resp);
+    };
+
+    if (!cursorToken) {
+        Mapper<Job> mp(dbClientPtr);
+        mp.orderBy(sortField, sortOrderEnum).offset(offset).limit(limit).findAll(respond, onError);
+        return;
+    }
+
+    // keyset: seek straight past the previous page instead of skipping rows
+    auto binder = *dbClientPtr << keysetSql(sortField, sortOrder);
+    if (sortField != "id") {
+        binder << cursor.key;
+    }
+    binder << cursor.id << std::to_string(limit);
+    binder >> [respond](const Result &result) {
+               std::vector<Job> jobs;
+               jobs.reserve(result.size());
+               for (auto row : result) {
+                   jobs.emplace_back(row);
+               }
+               respond(jobs);
+           }
+           >> onError;
 }
 
 void JobsController::getOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int jobId) const {
     LOG_DEBUG << "getOne jobId: "<< jobId;
+    auto *cachePtr = drogon::app().getPlugin<ResultCachePlugin>();
+    auto cacheKey = "id " + std::to_string(jobId);
+    auto etag = cachePtr->etag({"job"}, "/jobs " + cacheKey);
+    if (auto resp = ResultCachePlugin::notModified(req, etag)) {
+        callback(resp);
+        return;
+    }
+    if (auto cached = cachePtr->find("job", cacheKey)) {
+        callback(cached);
+        return;
+    }
+    auto version = cachePtr->version("job");
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req, !etag.empty());
+
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
 
     Mapper<Job> mp(dbClientPtr);
     mp.findByPrimaryKey(
         jobId,
-        [callbackPtr](const Job &job) {
+        [callbackPtr, cachePtr, cacheKey, version, etag](const Job &job) {
             Json::Value ret{};
             ret = job.toJson();
             auto resp = HttpResponse::newHttpJsonResponse(ret);
             resp->setStatusCode(HttpStatusCode::k201Created);
+            if (!etag.empty()) {
+                resp->addHeader("ETag", etag);
+            }
+            cachePtr->store("job", cacheKey, version, resp);
             (*callbackPtr)(resp);
         },
         [callbackPtr](const DrogonDbException &e) {
@@ -80,12 +186,13 @@ void JobsController::getOne(const HttpRequestPtr &req, std::function<void(const
 void JobsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Job &&pJob) const {
     LOG_DEBUG << "createOne";
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
 
     Mapper<Job> mp(dbClientPtr);
     mp.insert(
         pJob,
         [callbackPtr](const Job &job) {
+            drogon::app().getPlugin<ResultCachePlugin>()->invalidate("job");
             Json::Value ret{};
             ret = job.toJson();
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -112,53 +219,50 @@ void JobsController::updateOne(const HttpRequestPtr &req, std::function<void(con
       return;
     }
 
-    auto dbClientPtr = drogon::app().getDbClient();
-
-    // blocking IO
-    Mapper<Job> mp(dbClientPtr);
-    Job job;
-    try {
-        job = mp.findFutureByPrimaryKey(jobId).get();
-    } catch (const DrogonDbException & e) {
-        Json::Value ret{};
-        ret["error"] = "resource not found";
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
-        callback(resp);
-    }
-
-    if (pJobDetails.getTitle() != nullptr) {
-        job.setTitle(pJobDetails.getValueOfTitle());
+    if (pJobDetails.getTitle() == nullptr) {
+        badRequest(std::move(callback), "no fields to update");
+        return;
     }
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    mp.update(
-        job,
-        [callbackPtr](const std::size_t count)
-        {
-            auto resp = HttpResponse::newHttpResponse();
-            resp->setStatusCode(HttpStatusCode::k204NoContent);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e)
-        {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
-        }
-    );
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
+    *dbClientPtr << "update job set title = $2 where id = $1 returning *"
+                 << jobId
+                 << pJobDetails.getValueOfTitle()
+                 >> [callbackPtr](const Result &result)
+                   {
+                      if (result.empty()) {
+                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                          resp->setStatusCode(HttpStatusCode::k404NotFound);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+                      drogon::app().getPlugin<ResultCachePlugin>()->invalidate("job");
+                      auto resp = HttpResponse::newHttpResponse();
+                      resp->setStatusCode(HttpStatusCode::k204NoContent);
+                      (*callbackPtr)(resp);
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
 }
 
 void JobsController::deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int jobId) const {
     LOG_DEBUG << "deleteOne jobId: ";
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
 
     Mapper<Job> mp(dbClientPtr);
     mp.deleteBy(
         Criteria(Job::Cols::_id, CompareOperator::EQ, jobId),
         [callbackPtr](const std::size_t count) {
+            if (count > 0) {
+                drogon::app().getPlugin<ResultCachePlugin>()->invalidate("job");
+            }
             auto resp = HttpResponse::newHttpResponse();
             resp->setStatusCode(HttpStatusCode::k204NoContent);
             (*callbackPtr)(resp);
@@ -174,45 +278,20 @@ void JobsController::deleteOne(const HttpRequestPtr &req, std::function<void(con
 void JobsController::getJobPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int jobId) const {
     LOG_DEBUG << "getJobPersons jobId: "<< jobId;
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
-
-    // blocking IO
-    Mapper<Job> mp(dbClientPtr);
-    Job job;
-    try {
-        job = mp.findFutureByPrimaryKey(jobId).get();
-    } catch (const DrogonDbException & e) {
-        Json::Value ret{};
-        ret["error"] = "resource not found";
-        auto resp = HttpResponse::newHttpJsonResponse(ret);
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
-        callback(resp);
-    }
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
 
-    job.getPersons(dbClientPtr,
-        [callbackPtr](const std::vector<Person> persons) {
-           if (persons.empty()) {
-              Json::Value ret{};
-              ret["error"] = "resource not found";
-              auto resp = HttpResponse::newHttpJsonResponse(ret);
-              resp->setStatusCode(HttpStatusCode::k404NotFound);
-              (*callbackPtr)(resp);
-          } else {
-              Json::Value ret{};
-              for (auto p : persons) {
-                  ret.append(p.toJson());
-              }
-              auto resp = HttpResponse::newHttpJsonResponse(ret);
-              resp->setStatusCode(HttpStatusCode::k200OK);
-              (*callbackPtr)(resp);
-          }
-        },
-        [callbackPtr](const DrogonDbException &e) {
-          LOG_ERROR << e.base().what();
-          Json::Value ret{};
-          ret["error"] = "database error";
-          auto resp = HttpResponse::newHttpJsonResponse(ret);
-          resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-          (*callbackPtr)(resp);
-        });
+    static const auto sql = PersonsController::membersSql("job", "job_id");
+    *dbClientPtr << sql
+                 << jobId
+                 >> [callbackPtr](const Result &result)
+                   {
+                      (*callbackPtr)(PersonsController::membersResponse(result));
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
 }
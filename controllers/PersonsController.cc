@@ -1,9 +1,20 @@
 #include "PersonsController.h"
 #include "../utils/utils.h"
+#include "../plugins/OrgGraphPlugin.h"
+#include "../plugins/DbRouterPlugin.h"
+#include "../plugins/ResultCachePlugin.h"
+#include "../utils/RecordReader.h"
+#include "../utils/PersonJson.h"
 #include <memory>
 #include <utility>
 #include <vector>
-#include <regex>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <tuple>
+#include <limits>
+#include <cstdio>
+#include <fstream>
 
 using namespace drogon::orm;
 using namespace drogon_model::org_chart;
@@ -21,15 +32,356 @@ namespace drogon {
     }
 }  // namespace drogon
 
+namespace {
+// columns /persons can be sorted by, as named in the list query's output, and
+// the expression each one stands for in a where clause
+const std::pair<const char *, const char *> sortFields[] = {
+    {"id", "person.id"},
+    {"job_id", "person.job_id"},
+    {"department_id", "person.department_id"},
+    {"manager_id", "person.manager_id"},
+    {"first_name", "person.first_name"},
+    {"last_name", "person.last_name"},
+    {"hire_date", "person.hire_date"},
+    {"job_title", "job.title"},
+    {"department_name", "department.name"},
+    {"manager_full_name", "concat(manager.first_name, ' ', manager.last_name)"}};
+const char *sortOrders[] = {"asc", "desc"};
+
+constexpr size_t maxIdsPerRequest = 1000;
+// client_max_body_size is raised for /persons/import; a batch is parsed as
+// one json document, so it keeps the old limit and an item cap
+constexpr size_t maxBatchBytes = 1024 * 1024;
+constexpr Json::ArrayIndex maxBatchItems = 1000;
+
+// ids may arrive as strings, which fromRequest<Person> accepts as well
+void coerceIds(Json::Value &json) {
+    for (const auto *field : {"department_id", "manager_id", "job_id"}) {
+        if (json.isMember(field) && json[field].isString()) {
+            try {
+                json[field] = std::stoi(json[field].asString());
+            } catch (const std::exception &) {
+                // left as is for validation to reject
+            }
+        }
+    }
+}
+
+// Persons headed for one insertPersons() call, column by column. The whole
+// set goes in as one statement, hence one transaction, whose text does not
+// depend on the number of rows.
+struct PersonColumns {
+    std::vector<std::string> jobIds, departmentIds, managerIds, firstNames, lastNames, hireDates;
+
+    void add(const Person &person) {
+        jobIds.push_back(std::to_string(person.getValueOfJobId()));
+        departmentIds.push_back(std::to_string(person.getValueOfDepartmentId()));
+        managerIds.push_back(std::to_string(person.getValueOfManagerId()));
+        firstNames.push_back(person.getValueOfFirstName());
+        lastNames.push_back(person.getValueOfLastName());
+        hireDates.push_back(person.getValueOfHireDate().toDbStringLocal());
+    }
+    auto size() const -> size_t {
+        return firstNames.size();
+    }
+};
+
+// With skipConflicts, rows clashing with an existing person's unique
+// columns are left out of the result instead of failing the statement.
+void insertPersons(DbClient &client,
+                   const PersonColumns &columns,
+                   bool skipConflicts,
+                   std::function<void(const Result &)> &&rcb,
+                   std::function<void(const DrogonDbException &)> &&ecb) {
+    static const std::string sql = "insert into person (job_id, department_id, manager_id, first_name, last_name, hire_date) \n\
+                                    select * from unnest($1::int[], $2::int[], $3::int[], $4::varchar[], $5::varchar[], $6::date[]) \n";
+    static const std::string strictSql = sql + "returning *";
+    static const std::string skippingSql = sql + "on conflict do nothing \nreturning *";
+    client << (skipConflicts ? skippingSql : strictSql)
+           << toPgArray(columns.jobIds)
+           << toPgArray(columns.departmentIds)
+           << toPgArray(columns.managerIds)
+           << toPgArray(columns.firstNames)
+           << toPgArray(columns.lastNames)
+           << toPgArray(columns.hireDates)
+           >> std::move(rcb)
+           >> std::move(ecb);
+}
+
+// rows per insert while importing
+constexpr size_t importChunkRows = 1000;
+// rejected rows listed in an import report; the rest are only counted
+constexpr Json::ArrayIndex importReportedErrors = 100;
+
+// one running /persons/import, fed to the transaction a chunk at a time
+struct Import {
+    HttpRequestPtr req;  // owns the body the reader walks
+    RecordReader reader;
+    std::shared_ptr<Transaction> transaction;
+    std::shared_ptr<std::function<void(const HttpResponsePtr &)>> callback;
+    size_t imported{0};
+    size_t rejected{0};
+    Json::Value errors{Json::arrayValue};
+
+    Import(const HttpRequestPtr &req, RecordReader::Format format) : req{req}, reader{req->body(), format} {}
+
+    void reject(size_t line, const std::string &err) {
+        ++rejected;
+        if (errors.size() < importReportedErrors) {
+            Json::Value error{};
+            error["line"] = static_cast<Json::UInt64>(line);
+            error["error"] = err;
+            errors.append(error);
+        }
+    }
+    auto report() const -> Json::Value {
+        Json::Value ret{};
+        ret["imported"] = static_cast<Json::UInt64>(imported);
+        ret["rejected"] = static_cast<Json::UInt64>(rejected);
+        ret["errors"] = errors;
+        return ret;
+    }
+};
+
+void importNextChunk(const std::shared_ptr<Import> &import) {
+    PersonColumns columns;
+    Json::Value record;
+    std::string err;
+    size_t firstLine = 0;
+    while (columns.size() < importChunkRows && import->reader.next(record, err)) {
+        if (err.empty()) {
+            coerceIds(record);
+            Person::validateJsonForCreation(record, err);
+        }
+        if (!err.empty()) {
+            import->reject(import->reader.line(), err);
+            continue;
+        }
+        firstLine = firstLine == 0 ? import->reader.line() : firstLine;
+        columns.add(Person(record));
+    }
+
+    if (columns.size() == 0) {
+        // releasing the transaction commits it, the commit callback reports
+        import->transaction.reset();
+        return;
+    }
+    auto lastLine = import->reader.line();
+    insertPersons(
+        *import->transaction,
+        columns,
+        false,
+        [import](const Result &result) {
+            import->imported += result.size();
+            importNextChunk(import);
+        },
+        [import, firstLine, lastLine](const DrogonDbException &e) {
+            // the transaction has rolled back already
+            LOG_ERROR << e.base().what();
+            import->transaction.reset();
+            import->imported = 0;
+            auto ret = import->report();
+            ret["error"] = "database error in lines " + std::to_string(firstLine) + "-" + std::to_string(lastLine);
+            auto resp = HttpResponse::newHttpJsonResponse(ret);
+            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+            (*import->callback)(resp);
+        });
+}
+}  // namespace
+
+auto PersonsController::listSql(const std::string &sortField, const std::string &sortOrder, bool afterCursor)
+    -> const std::string * {
+    // one finished statement per whitelisted (field, order) pair and paging
+    // mode; the texts never change, so drogon prepares each at most once per
+    // connection
+    static const auto statements = [] {
+        std::map<std::tuple<std::string, std::string, bool>, std::string> ret;
+        for (const auto &field : sortFields) {
+            for (const auto *order : sortOrders) {
+                const std::string name = field.first;
+                const std::string select = "select person.*, \n\
+                                   job.title as job_title, \n\
+                                   department.name as department_name, \n\
+                                   concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n\
+                                   from person \n\
+                                   join job on person.job_id =job.id \n\
+                                   join department on person.department_id=department.id \n\
+                                   join person as manager on person.manager_id = manager.id \n";
+                auto orderBy = "order by " + name + " " + order;
+                if (name != "id") {
+                    orderBy += std::string(", id ") + order;
+                }
+                ret.emplace(std::make_tuple(name, order, false), select + orderBy + " \nlimit $1 offset $2;");
+
+                // keyset: seek past the (key, id) of the previous page's last
+                // row instead of counting off `offset` rows
+                const auto *cmp = std::string(order) == "asc" ? " > " : " < ";
+                auto where = name == "id" ? std::string("where person.id") + cmp + "$1 \n"
+                                          : std::string("where (") + field.second + ", person.id)" + cmp +
+                                                "($1, $2) \n";
+                auto limit = name == "id" ? " \nlimit $2;" : " \nlimit $3;";
+                ret.emplace(std::make_tuple(name, order, true), select + where + orderBy + limit);
+            }
+        }
+        return ret;
+    }();
+
+    auto it = statements.find(std::make_tuple(sortField, sortOrder, afterCursor));
+    return it == statements.end() ? nullptr : &it->second;
+}
+
+auto PersonsController::membersSql(const std::string &parentTable, const std::string &column) -> std::string {
+    return "select member.*, \n\
+            exists (select 1 from " + parentTable + " where id = $1) as parent_exists \n\
+            from (select 1) as one \n\
+            left join (select person.*, \n\
+                       job.title as job_title, \n\
+                       department.name as department_name, \n\
+                       concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n\
+                       from person \n\
+                       join job on person.job_id =job.id \n\
+                       join department on person.department_id=department.id \n\
+                       join person as manager on person.manager_id = manager.id \n\
+                       where person." + column + " = $1) as member on true \n\
+            order by member.id";
+}
+
+auto PersonsController::membersResponse(const Result &result) -> HttpResponsePtr {
+    if (result.empty() || !result[0]["parent_exists"].as<bool>()) {
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+        resp->setStatusCode(HttpStatusCode::k404NotFound);
+        return resp;
+    }
+
+    auto graph = drogon::app().getPlugin<OrgGraphPlugin>();
+    PersonJsonWriter writer{result};
+    std::string body;
+    body.reserve(result.size() * 256);
+    for (auto row : result) {
+        if (row["id"].isNull()) {
+            continue;
+        }
+        writer.appendElement(body, row, graph->headcount(row["id"].as<int32_t>()));
+    }
+    auto resp = newJsonArrayResponse(std::move(body));
+    resp->setStatusCode(HttpStatusCode::k200OK);
+    return resp;
+}
+
 void PersonsController::get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
     LOG_DEBUG << "get";
     auto sort_field = req->getOptionalParameter<std::string>("sort_field").value_or("id");
     auto sort_order = req->getOptionalParameter<std::string>("sort_order").value_or("asc");
     auto limit = req->getOptionalParameter<int>("limit").value_or(25);
     auto offset = req->getOptionalParameter<int>("offset").value_or(0);
+    auto cursorToken = req->getOptionalParameter<std::string>("cursor");
+    auto ids = req->getOptionalParameter<std::string>("ids");
+    if (ids) {
+        getByIds(req, std::move(callback), *ids);
+        return;
+    }
+
+    PageCursor cursor;
+    if (cursorToken) {
+        if (!decodeCursor(*cursorToken, cursor)) {
+            badRequest(std::move(callback), "invalid cursor");
+            return;
+        }
+        // a cursor only makes sense in the order its page was read in
+        sort_field = cursor.sortField;
+        sort_order = cursor.sortOrder;
+    }
+
+    const auto *sql = listSql(sort_field, sort_order, cursorToken.has_value());
+    if (sql == nullptr) {
+        badRequest(std::move(callback), "unsupported sort_field or sort_order");
+        return;
+    }
+
+    auto etag = drogon::app().getPlugin<ResultCachePlugin>()->etag(
+        {"person", "department", "job"},
+        "/persons list " + sort_field + " " + sort_order + " " + std::to_string(limit) + " " +
+            (cursorToken ? "after " + *cursorToken : std::to_string(offset)));
+    if (auto resp = ResultCachePlugin::notModified(req, etag)) {
+        callback(resp);
+        return;
+    }
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    // tagged answers come from the primary, which has every write etag counts
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req, !etag.empty());
+    auto binder = *dbClientPtr << *sql;
+    if (!cursorToken) {
+        binder << std::to_string(limit) << std::to_string(offset);
+    } else if (sort_field == "id") {
+        binder << cursor.id << std::to_string(limit);
+    } else {
+        binder << cursor.key << cursor.id << std::to_string(limit);
+    }
+    binder >> [callbackPtr, sort_field, sort_order, limit, etag, paged = cursorToken.has_value()](const Result &result)
+              {
+                 // a cursor past the last full page just has nothing left
+                 if (result.empty() && !paged) {
+                     auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                     resp->setStatusCode(HttpStatusCode::k404NotFound);
+                     (*callbackPtr)(resp);
+                     return;
+                 }
+
+                 auto graph = drogon::app().getPlugin<OrgGraphPlugin>();
+                 PersonJsonWriter writer{result};
+                 std::string body;
+                 body.reserve(result.size() * 256);
+                 for (auto row : result) {
+                     writer.appendElement(body, row, graph->headcount(row["id"].as<int32_t>()));
+                 }
+
+                 auto resp = newJsonArrayResponse(std::move(body));
+                 resp->setStatusCode(HttpStatusCode::k200OK);
+                 if (!result.empty() && result.size() == static_cast<size_t>(limit)) {
+                     auto last = result[result.size() - 1];
+                     addNextCursor(resp, PageCursor{sort_field, sort_order, last[sort_field].as<std::string>(),
+                                                    last["id"].as<int32_t>()});
+                 }
+                 if (!etag.empty()) {
+                     resp->addHeader("ETag", etag);
+                 }
+                 (*callbackPtr)(resp);
+              }
+           >> [callbackPtr](const DrogonDbException &e)
+              {
+                 LOG_ERROR << e.base().what();
+                 auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                 resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                 (*callbackPtr)(resp);
+              };
+}
+
+void PersonsController::getByIds(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, const std::string &idList) {
+    std::vector<int32_t> ids;
+    if (!parseIdList(idList, ids)) {
+        badRequest(std::move(callback), "ids must be a comma-separated list of person ids");
+        return;
+    }
+    if (ids.size() > maxIdsPerRequest) {
+        badRequest(std::move(callback), "at most " + std::to_string(maxIdsPerRequest) + " ids per request");
+        return;
+    }
+    std::vector<std::string> elements;
+    elements.reserve(ids.size());
+    for (auto id : ids) {
+        elements.push_back(std::to_string(id));
+    }
+    auto etag = drogon::app().getPlugin<ResultCachePlugin>()->etag({"person", "department", "job"},
+                                                                   "/persons ids " + idList);
+    if (auto resp = ResultCachePlugin::notModified(req, etag)) {
+        callback(resp);
+        return;
+    }
+
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req, !etag.empty());
+
     const char *sql = "select person.*, \n\
                        job.title as job_title, \n\
                        department.name as department_name, \n\
@@ -38,34 +390,39 @@ void PersonsController::get(const HttpRequestPtr &req, std::function<void(const
                        join job on person.job_id =job.id \n\
                        join department on person.department_id=department.id \n\
                        join person as manager on person.manager_id = manager.id \n\
-                       order by $sort_field $sort_order \n\
-                       limit $1 offset $2;";
-
-    // hack workaroun
-    auto sql_sub = std::regex_replace(sql, std::regex("\\$sort_field"), sort_field);
-    sql_sub = std::regex_replace(sql_sub, std::regex("\\$sort_order"), sort_order);
+                       where person.id = any($1::int[])";
 
-    *dbClientPtr << std::string(sql_sub)
-                 << std::to_string(limit)
-                 << std::to_string(offset)
-                 >> [callbackPtr](const Result &result)
+    *dbClientPtr << std::string(sql)
+                 << toPgArray(elements)
+                 >> [callbackPtr, ids = std::move(ids), etag](const Result &result)
                    {
-                      if (result.empty()) {
-                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-                          resp->setStatusCode(HttpStatusCode::k404NotFound);
-                          (*callbackPtr)(resp);
-                          return;
+                      std::unordered_map<int32_t, size_t> rows;
+                      for (size_t i = 0; i < result.size(); ++i) {
+                          rows.emplace(result[i]["id"].as<int32_t>(), i);
                       }
 
-                      Json::Value ret{};
-                      for (auto row : result) {
-                          PersonInfo personInfo{row};
-                          PersonDetails personDetails{personInfo};
-                          ret.append(personDetails.toJson());
+                      auto graph = drogon::app().getPlugin<OrgGraphPlugin>();
+                      PersonJsonWriter writer{result};
+                      std::string body;
+                      body.reserve(result.size() * 256);
+                      std::string missing;
+                      for (auto id : ids) {
+                          auto row = rows.find(id);
+                          if (row == rows.end()) {
+                              missing += (missing.empty() ? "" : ",") + std::to_string(id);
+                              continue;
+                          }
+                          writer.appendElement(body, result[row->second], graph->headcount(id));
                       }
 
-                      auto resp = HttpResponse::newHttpJsonResponse(ret);
+                      auto resp = newJsonArrayResponse(std::move(body));
                       resp->setStatusCode(HttpStatusCode::k200OK);
+                      if (!missing.empty()) {
+                          resp->addHeader("Missing-Ids", missing);
+                      }
+                      if (!etag.empty()) {
+                          resp->addHeader("ETag", etag);
+                      }
                       (*callbackPtr)(resp);
                    }
                  >> [callbackPtr](const DrogonDbException &e)
@@ -79,8 +436,14 @@ void PersonsController::get(const HttpRequestPtr &req, std::function<void(const
 
 void PersonsController::getOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
     LOG_DEBUG << "getOne personId: "<< personId;
+    auto etag = drogon::app().getPlugin<ResultCachePlugin>()->etag({"person", "department", "job"},
+                                                                   "/persons id " + std::to_string(personId));
+    if (auto resp = ResultCachePlugin::notModified(req, etag)) {
+        callback(resp);
+        return;
+    }
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req, !etag.empty());
 
     const char *sql = "select person.*, \n\
                        job.title as job_title, \n\
@@ -94,7 +457,7 @@ void PersonsController::getOne(const HttpRequestPtr &req, std::function<void(con
 
     *dbClientPtr << std::string(sql)
                  << personId
-                 >> [callbackPtr](const Result &result)
+                 >> [callbackPtr, etag](const Result &result)
                    {
                       if (result.empty()) {
                           auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
@@ -103,13 +466,15 @@ void PersonsController::getOne(const HttpRequestPtr &req, std::function<void(con
                           return;
                       }
 
-                      auto row = result[0];
-                      PersonInfo personInfo{row};
+                      PersonInfo personInfo{result[0], PersonInfo::columnsOf(result)};
                       PersonDetails personDetails{personInfo};
 
                       Json::Value ret = personDetails.toJson();
                       auto resp = HttpResponse::newHttpJsonResponse(ret);
                       resp->setStatusCode(HttpStatusCode::k200OK);
+                      if (!etag.empty()) {
+                          resp->addHeader("ETag", etag);
+                      }
                       (*callbackPtr)(resp);
                    }
                  >> [callbackPtr](const DrogonDbException &e)
@@ -124,12 +489,14 @@ void PersonsController::getOne(const HttpRequestPtr &req, std::function<void(con
 void PersonsController::createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Person &&pPerson) const {
     LOG_DEBUG << "createOne";
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
 
     Mapper<Person> mp(dbClientPtr);
     mp.insert(
         pPerson,
         [callbackPtr](const Person &person) {
+            drogon::app().getPlugin<OrgGraphPlugin>()->upsert(person);
+            drogon::app().getPlugin<ResultCachePlugin>()->invalidate("person");
             Json::Value ret{};
             ret = person.toJson();
             auto resp = HttpResponse::newHttpJsonResponse(ret);
@@ -144,66 +511,381 @@ void PersonsController::createOne(const HttpRequestPtr &req, std::function<void(
     });
 }
 
-void PersonsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId, Person &&pPerson) const {
-    LOG_DEBUG << "updateOne personId: " << personId;
-    auto dbClientPtr = drogon::app().getDbClient();
+void PersonsController::createBatch(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "createBatch";
+    if (req->body().size() > maxBatchBytes) {
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("batch body over " + std::to_string(maxBatchBytes) +
+                                                                  " bytes, use /persons/import"));
+        resp->setStatusCode(HttpStatusCode::k413RequestEntityTooLarge);
+        callback(resp);
+        return;
+    }
+    auto jsonPtr = req->getJsonObject();
+    if (!jsonPtr || !jsonPtr->isArray()) {
+        badRequest(std::move(callback), "expected a json array of persons");
+        return;
+    }
+    if (jsonPtr->size() > maxBatchItems) {
+        badRequest(std::move(callback), "at most " + std::to_string(maxBatchItems) + " persons per batch");
+        return;
+    }
 
-    // blocking IO
-    Mapper<Person> mp(dbClientPtr);
-    Person person;
-    try {
-        person = mp.findFutureByPrimaryKey(personId).get();
-    } catch (const DrogonDbException & e) {
-        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
+    // one result per item, in request order; items failing validation or
+    // clashing with an earlier item are answered right away, the rest go
+    // into a single insert
+    auto results = std::make_shared<Json::Value>(Json::arrayValue);
+    // result slot and unique (first_name, last_name) of every inserted item
+    auto inserted = std::make_shared<std::vector<std::pair<Json::ArrayIndex, std::pair<std::string, std::string>>>>();
+    PersonColumns columns;
+    // each of these is unique on its own in the person table
+    std::set<std::string> firstNames, lastNames, hireDates;
+    for (Json::ArrayIndex i = 0; i < jsonPtr->size(); ++i) {
+        auto json = (*jsonPtr)[i];
+        std::string err;
+        Json::Value result{};
+        if (json.isObject()) {
+            coerceIds(json);
+        }
+        if (!json.isObject() || !Person::validateJsonForCreation(json, err)) {
+            result["status"] = static_cast<int>(k400BadRequest);
+            result["error"] = json.isObject() ? err : "expected a json object";
+            results->append(result);
+            continue;
+        }
+        Person person(json);
+        auto hireDate = person.getValueOfHireDate().toDbStringLocal();
+        const char *clash = firstNames.count(person.getValueOfFirstName()) ? "first_name"
+                            : lastNames.count(person.getValueOfLastName()) ? "last_name"
+                            : hireDates.count(hireDate)                     ? "hire_date"
+                                                                            : nullptr;
+        if (clash != nullptr) {
+            result["status"] = static_cast<int>(k409Conflict);
+            result["error"] = std::string("duplicate ") + clash + " within the batch";
+            results->append(result);
+            continue;
+        }
+        firstNames.insert(person.getValueOfFirstName());
+        lastNames.insert(person.getValueOfLastName());
+        hireDates.insert(hireDate);
+        columns.add(person);
+        inserted->emplace_back(results->size(), std::make_pair(person.getValueOfFirstName(), person.getValueOfLastName()));
+        results->append(result);
+    }
+
+    if (columns.size() == 0) {
+        auto resp = HttpResponse::newHttpJsonResponse(*results);
+        resp->setStatusCode(HttpStatusCode::k200OK);
         callback(resp);
         return;
     }
 
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
+    insertPersons(
+        *dbClientPtr,
+        columns,
+        true,
+        [callbackPtr, results, inserted](const Result &result) {
+            // insert ... select does not promise to return rows in input
+            // order, so match them up by their unique names; rows skipped
+            // for clashing with an existing person come back missing
+            std::map<std::pair<std::string, std::string>, Json::Value> created;
+            for (auto row : result) {
+                Person person(row);
+                drogon::app().getPlugin<OrgGraphPlugin>()->upsert(person);
+                created.emplace(std::make_pair(person.getValueOfFirstName(), person.getValueOfLastName()),
+                                person.toJson());
+            }
+            drogon::app().getPlugin<ResultCachePlugin>()->invalidate("person");
+            for (const auto &item : *inserted) {
+                auto &slot = (*results)[item.first];
+                auto it = created.find(item.second);
+                if (it == created.end()) {
+                    slot["status"] = static_cast<int>(k409Conflict);
+                    slot["error"] = "a person with this first_name, last_name or hire_date already exists";
+                    continue;
+                }
+                slot["status"] = static_cast<int>(k201Created);
+                slot["person"] = it->second;
+            }
+
+            auto resp = HttpResponse::newHttpJsonResponse(*results);
+            resp->setStatusCode(HttpStatusCode::k200OK);
+            (*callbackPtr)(resp);
+        },
+        [callbackPtr](const DrogonDbException &e) {
+            LOG_ERROR << e.base().what();
+            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+            (*callbackPtr)(resp);
+    });
+}
+
+void PersonsController::importPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "importPersons";
+    auto format = req->getOptionalParameter<std::string>("format").value_or("");
+    if (format.empty()) {
+        const auto &contentType = req->getHeader("content-type");
+        if (contentType.find("csv") != std::string::npos) {
+            format = "csv";
+        } else if (contentType.find("ndjson") != std::string::npos) {
+            format = "ndjson";
+        }
+    }
+    if (format != "csv" && format != "ndjson") {
+        badRequest(std::move(callback), "send text/csv or application/x-ndjson, or pass format=csv|ndjson");
+        return;
+    }
+
+    auto import = std::make_shared<Import>(req, format == "csv" ? RecordReader::Format::csv : RecordReader::Format::ndjson);
+    import->callback = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    drogon::app().getPlugin<DbRouterPlugin>()->writer(req)->newTransactionAsync([import](const std::shared_ptr<Transaction> &transaction) {
+        transaction->setCommitCallback([import](bool committed) {
+            if (!committed) {
+                import->imported = 0;
+            }
+            auto ret = import->report();
+            if (!committed) {
+                ret["error"] = "database error";
+            } else if (import->imported > 0) {
+                // far too many rows to replay one by one into the org graph
+                drogon::app().getPlugin<OrgGraphPlugin>()->reload();
+                drogon::app().getPlugin<ResultCachePlugin>()->invalidate("person");
+            }
+            auto resp = HttpResponse::newHttpJsonResponse(ret);
+            resp->setStatusCode(committed ? HttpStatusCode::k200OK : HttpStatusCode::k500InternalServerError);
+            (*import->callback)(resp);
+        });
+        import->transaction = transaction;
+        importNextChunk(import);
+    });
+}
+
+// One running /persons/export. drogon cannot stream a response body, so a
+// server-side cursor is drained batch by batch into a temp file, which then
+// goes out through sendfile: memory stays at one batch and the kernel paces
+// the transfer to the client.
+struct PersonsController::Export {
+    static constexpr size_t batchRows = 5000;
+
+    bool csv{false};
+    std::string path;
+    std::ofstream out;
+    std::shared_ptr<Transaction> transaction;
+    std::shared_ptr<std::function<void(const HttpResponsePtr &)>> callback;
+
+    void fail() {
+        transaction.reset();
+        out.close();
+        std::remove(path.c_str());
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+        resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+        (*callback)(resp);
+    }
+};
+
+void PersonsController::exportNextBatch(const std::shared_ptr<Export> &exp) {
+    *exp->transaction << "fetch " + std::to_string(Export::batchRows) + " from persons_export"
+                      >> [exp](const Result &result)
+                        {
+                           std::string batch;
+                           auto columns = PersonInfo::columnsOf(result);
+                           for (auto row : result) {
+                               PersonInfo personInfo{row, columns};
+                               PersonDetails personDetails{personInfo};
+                               if (!exp->csv) {
+                                   appendJsonLine(batch, personDetails.toJson());
+                                   continue;
+                               }
+                               auto json = personDetails.toJson();
+                               for (const auto &field : {json["id"], json["first_name"], json["last_name"],
+                                                         json["hire_date"], json["manager"]["id"],
+                                                         json["manager"]["full_name"], json["department"]["id"],
+                                                         json["department"]["name"], json["job"]["id"],
+                                                         json["job"]["title"], json["headcount"]}) {
+                                   appendCsvField(batch, field.isNull() ? "" : field.asString());
+                                   batch += ',';
+                               }
+                               batch.back() = '\n';
+                           }
+                           exp->out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                           if (!exp->out) {
+                               LOG_ERROR << "export: writing " << exp->path << " failed";
+                               exp->transaction->rollback();
+                               exp->fail();
+                               return;
+                           }
+                           if (result.size() < Export::batchRows) {
+                               // releasing the transaction commits it and closes the cursor
+                               exp->transaction.reset();
+                               return;
+                           }
+                           exportNextBatch(exp);
+                        }
+                      >> [exp](const DrogonDbException &e)
+                        {
+                           LOG_ERROR << e.base().what();
+                           exp->fail();
+                        };
+}
+
+void PersonsController::exportPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "exportPersons";
+    auto format = req->getOptionalParameter<std::string>("format").value_or("ndjson");
+    if (format != "ndjson" && format != "csv") {
+        badRequest(std::move(callback), "format must be ndjson or csv");
+        return;
+    }
+
+    auto exp = std::make_shared<Export>();
+    exp->csv = format == "csv";
+    exp->path = drogon::app().getUploadPath() + "/tmp/persons-export-" + drogon::utils::getUuid() + "." + format;
+    exp->callback = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    exp->out.open(exp->path, std::ios::binary | std::ios::trunc);
+    if (!exp->out) {
+        LOG_ERROR << "export: cannot create " << exp->path;
+        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("cannot create export file"));
+        resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+        (*exp->callback)(resp);
+        return;
+    }
+    if (exp->csv) {
+        exp->out << "id,first_name,last_name,hire_date,manager_id,manager_full_name,"
+                    "department_id,department_name,job_id,job_title,headcount\n";
+    }
+
+    const char *sql = "declare persons_export no scroll cursor for \n\
+                       select person.*, \n\
+                       job.title as job_title, \n\
+                       department.name as department_name, \n\
+                       concat(manager.first_name, ' ', manager.last_name) as manager_full_name \n\
+                       from person \n\
+                       join job on person.job_id =job.id \n\
+                       join department on person.department_id=department.id \n\
+                       join person as manager on person.manager_id = manager.id \n\
+                       order by person.id";
+
+    drogon::app().getPlugin<DbRouterPlugin>()->reader(req)->newTransactionAsync([exp, sql](const std::shared_ptr<Transaction> &transaction) {
+        transaction->setCommitCallback([exp](bool committed) {
+            exp->out.close();
+            if (!committed || !exp->out) {
+                std::remove(exp->path.c_str());
+                auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                (*exp->callback)(resp);
+                return;
+            }
+            auto resp = HttpResponse::newFileResponse(exp->path,
+                                                      exp->csv ? "persons.csv" : "persons.ndjson",
+                                                      CT_CUSTOM,
+                                                      exp->csv ? "text/csv" : "application/x-ndjson");
+            (*exp->callback)(resp);
+            // large files are opened only once the response is written out,
+            // so leave the file around for a while before removing it
+            drogon::app().getLoop()->runAfter(60.0, [path = exp->path] { std::remove(path.c_str()); });
+        });
+        exp->transaction = transaction;
+        *transaction << std::string(sql)
+                     >> [exp](const Result &) { exportNextBatch(exp); }
+                     >> [exp](const DrogonDbException &e) {
+                            LOG_ERROR << e.base().what();
+                            exp->fail();
+                        };
+    });
+}
+
+void PersonsController::updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId, Person &&pPerson) const {
+    LOG_DEBUG << "updateOne personId: " << personId;
+
+    // set only the columns the request carries, always in this order, so each
+    // combination is one stable statement that drogon prepares once
+    std::string columns;
+    auto param = 1;
+    auto set = [&columns, &param](const char *column) {
+        columns += (columns.empty() ? "" : ", ") + std::string(column) + " = $" + std::to_string(++param);
+    };
     if (pPerson.getJobId() != nullptr) {
-      person.setJobId(pPerson.getValueOfJobId());
+        set("job_id");
     }
     if (pPerson.getManagerId() != nullptr) {
-      person.setManagerId(pPerson.getValueOfManagerId());
+        set("manager_id");
     }
     if (pPerson.getDepartmentId() != nullptr) {
-      person.setDepartmentId(pPerson.getValueOfDepartmentId());
+        set("department_id");
     }
     if (pPerson.getFirstName() != nullptr) {
-      person.setFirstName(pPerson.getValueOfFirstName());
+        set("first_name");
     }
     if (pPerson.getLastName() != nullptr) {
-      person.setLastName(pPerson.getValueOfLastName());
+        set("last_name");
+    }
+    if (pPerson.getHireDate() != nullptr) {
+        set("hire_date");
+    }
+    if (columns.empty()) {
+        badRequest(std::move(callback), "no fields to update");
+        return;
     }
 
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    mp.update(
-        person,
-        [callbackPtr](const std::size_t count)
-        {
-            auto resp = HttpResponse::newHttpResponse();
-            resp->setStatusCode(HttpStatusCode::k204NoContent);
-            (*callbackPtr)(resp);
-        },
-        [callbackPtr](const DrogonDbException &e)
-        {
-            LOG_ERROR << e.base().what();
-            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-            resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-            (*callbackPtr)(resp);
-        }
-    );
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
+    auto binder = *dbClientPtr << "update person set " + columns + " where id = $1 returning *";
+    binder << personId;
+    if (pPerson.getJobId() != nullptr) {
+        binder << pPerson.getValueOfJobId();
+    }
+    if (pPerson.getManagerId() != nullptr) {
+        binder << pPerson.getValueOfManagerId();
+    }
+    if (pPerson.getDepartmentId() != nullptr) {
+        binder << pPerson.getValueOfDepartmentId();
+    }
+    if (pPerson.getFirstName() != nullptr) {
+        binder << pPerson.getValueOfFirstName();
+    }
+    if (pPerson.getLastName() != nullptr) {
+        binder << pPerson.getValueOfLastName();
+    }
+    if (pPerson.getHireDate() != nullptr) {
+        binder << pPerson.getValueOfHireDate();
+    }
+    binder >> [callbackPtr](const Result &result)
+              {
+                 if (result.empty()) {
+                     auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                     resp->setStatusCode(HttpStatusCode::k404NotFound);
+                     (*callbackPtr)(resp);
+                     return;
+                 }
+
+                 drogon::app().getPlugin<OrgGraphPlugin>()->upsert(Person(result[0]));
+                 drogon::app().getPlugin<ResultCachePlugin>()->invalidate("person");
+                 auto resp = HttpResponse::newHttpResponse();
+                 resp->setStatusCode(HttpStatusCode::k204NoContent);
+                 (*callbackPtr)(resp);
+              }
+           >> [callbackPtr](const DrogonDbException &e)
+              {
+                 LOG_ERROR << e.base().what();
+                 auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                 resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                 (*callbackPtr)(resp);
+              };
 }
 
 void PersonsController::deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
     LOG_DEBUG << "deleteOne personId: ";
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->writer(req);
 
     Mapper<Person> mp(dbClientPtr);
     mp.deleteBy(
         Criteria(Person::Cols::_id, CompareOperator::EQ, personId),
-        [callbackPtr](const std::size_t count) {
+        [callbackPtr, personId](const std::size_t count) {
+            if (count > 0) {
+                drogon::app().getPlugin<OrgGraphPlugin>()->erase(personId);
+                drogon::app().getPlugin<ResultCachePlugin>()->invalidate("person");
+            }
             auto resp = HttpResponse::newHttpResponse();
             resp->setStatusCode(HttpStatusCode::k204NoContent);
             (*callbackPtr)(resp);
@@ -218,42 +900,368 @@ void PersonsController::deleteOne(const HttpRequestPtr &req, std::function<void(
 
 void PersonsController::getDirectReports(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
     LOG_DEBUG << "getDirectReports personId: "<< personId;
+
+    // served from the in-memory org graph once it is loaded
+    auto graph = drogon::app().getPlugin<OrgGraphPlugin>()->snapshot();
+    if (graph) {
+        auto index = graph->indexOf(personId);
+        if (index == OrgGraph::npos) {
+            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+            resp->setStatusCode(HttpStatusCode::k404NotFound);
+            callback(resp);
+            return;
+        }
+        Json::Value ret{Json::arrayValue};
+        auto reports = graph->directReports(index);
+        for (auto it = reports.first; it != reports.second; ++it) {
+            ret.append(graph->person(*it).toJson());
+        }
+        auto resp = HttpResponse::newHttpJsonResponse(ret);
+        resp->setStatusCode(HttpStatusCode::k200OK);
+        callback(resp);
+        return;
+    }
+
     auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
-    auto dbClientPtr = drogon::app().getDbClient();
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
 
-    // blocking IO
-    Mapper<Person> mp(dbClientPtr);
-    Person department;
-    try {
-        department = mp.findFutureByPrimaryKey(personId).get();
-    } catch (const DrogonDbException & e) {
-        auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-        resp->setStatusCode(HttpStatusCode::k404NotFound);
+    // reports and whether the manager exists in one round trip; a root
+    // manages themselves but is not their own report
+    const char *sql = "select person.*, \n\
+                       exists (select 1 from person where id = $1) as parent_exists \n\
+                       from (select 1) as one \n\
+                       left join person on person.manager_id = $1 and person.id <> $1 \n\
+                       order by person.id";
+
+    *dbClientPtr << std::string(sql)
+                 << personId
+                 >> [callbackPtr](const Result &result)
+                   {
+                      if (result.empty() || !result[0]["parent_exists"].as<bool>()) {
+                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                          resp->setStatusCode(HttpStatusCode::k404NotFound);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+
+                      Json::Value ret{Json::arrayValue};
+                      for (auto row : result) {
+                          if (!row["id"].isNull()) {
+                              ret.append(Person(row).toJson());
+                          }
+                      }
+                      auto resp = HttpResponse::newHttpJsonResponse(ret);
+                      resp->setStatusCode(HttpStatusCode::k200OK);
+                      (*callbackPtr)(resp);
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
+}
+
+void PersonsController::getSubtree(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
+    LOG_DEBUG << "getSubtree personId: "<< personId;
+    auto maxDepth = req->getOptionalParameter<int>("max_depth").value_or(std::numeric_limits<int>::max());
+    if (maxDepth < 0) {
+        badRequest(std::move(callback), "max_depth must not be negative");
+        return;
+    }
+
+    auto graph = drogon::app().getPlugin<OrgGraphPlugin>()->snapshot();
+    if (graph) {
+        auto index = graph->indexOf(personId);
+        if (index == OrgGraph::npos) {
+            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+            resp->setStatusCode(HttpStatusCode::k404NotFound);
+            callback(resp);
+            return;
+        }
+        std::string body;
+        for (const auto &node : graph->subtree(index, maxDepth)) {
+            auto ret = graph->person(node.first).toJson();
+            ret["depth"] = node.second;
+            appendJsonElement(body, ret);
+        }
+        auto resp = newJsonArrayResponse(std::move(body));
+        resp->setStatusCode(HttpStatusCode::k200OK);
+        callback(resp);
+        return;
+    }
+
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
+    const char *sql = "with recursive subtree as ( \n\
+                           select person.*, 0 as depth, array[person.id] as path \n\
+                           from person where person.id = $1 \n\
+                           union all \n\
+                           select person.*, subtree.depth + 1, subtree.path || person.id \n\
+                           from person \n\
+                           join subtree on person.manager_id = subtree.id \n\
+                           where subtree.depth < $2 and person.id <> all(subtree.path) \n\
+                       ) \n\
+                       select id, job_id, department_id, manager_id, first_name, last_name, hire_date, depth \n\
+                       from subtree \n\
+                       order by depth, id";
+
+    *dbClientPtr << std::string(sql)
+                 << personId
+                 << maxDepth
+                 >> [callbackPtr](const Result &result)
+                   {
+                      if (result.empty()) {
+                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                          resp->setStatusCode(HttpStatusCode::k404NotFound);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+
+                      std::string body;
+                      for (auto row : result) {
+                          auto ret = Person(row).toJson();
+                          ret["depth"] = row["depth"].as<int>();
+                          appendJsonElement(body, ret);
+                      }
+                      auto resp = newJsonArrayResponse(std::move(body));
+                      resp->setStatusCode(HttpStatusCode::k200OK);
+                      (*callbackPtr)(resp);
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
+}
+
+void PersonsController::getChain(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId) const {
+    LOG_DEBUG << "getChain personId: "<< personId;
+    // level=N asks for the single manager N levels up instead of the whole chain
+    auto level = req->getOptionalParameter<int>("level");
+    auto maxLevels = level ? *level : req->getOptionalParameter<int>("max_levels").value_or(std::numeric_limits<int>::max());
+    if (maxLevels < 0) {
+        badRequest(std::move(callback), "level must not be negative");
+        return;
+    }
+
+    auto graph = drogon::app().getPlugin<OrgGraphPlugin>()->snapshot();
+    if (graph) {
+        auto index = graph->indexOf(personId);
+        if (level && index != OrgGraph::npos) {
+            index = graph->ancestor(index, *level);
+        }
+        if (index == OrgGraph::npos) {
+            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+            resp->setStatusCode(HttpStatusCode::k404NotFound);
+            callback(resp);
+            return;
+        }
+        if (level) {
+            auto ret = graph->person(index).toJson();
+            ret["level"] = *level;
+            auto resp = HttpResponse::newHttpJsonResponse(ret);
+            resp->setStatusCode(HttpStatusCode::k200OK);
+            callback(resp);
+            return;
+        }
+        std::string body;
+        auto levelOf = 0;
+        for (auto i : graph->chain(index, maxLevels)) {
+            auto ret = graph->person(i).toJson();
+            ret["level"] = levelOf++;
+            appendJsonElement(body, ret);
+        }
+        auto resp = newJsonArrayResponse(std::move(body));
+        resp->setStatusCode(HttpStatusCode::k200OK);
+        callback(resp);
+        return;
+    }
+
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
+    const char *sql = "with recursive chain as ( \n\
+                           select person.*, 0 as level, array[person.id] as path \n\
+                           from person where person.id = $1 \n\
+                           union all \n\
+                           select manager.*, chain.level + 1, chain.path || manager.id \n\
+                           from person as manager \n\
+                           join chain on manager.id = chain.manager_id \n\
+                           where chain.level < $2 and manager.id <> all(chain.path) \n\
+                       ) \n\
+                       select id, job_id, department_id, manager_id, first_name, last_name, hire_date, level \n\
+                       from chain \n\
+                       order by level";
+
+    *dbClientPtr << std::string(sql)
+                 << personId
+                 << maxLevels
+                 >> [callbackPtr, level](const Result &result)
+                   {
+                      if (result.empty() || (level && result[result.size() - 1]["level"].as<int>() != *level)) {
+                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                          resp->setStatusCode(HttpStatusCode::k404NotFound);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+
+                      if (level) {
+                          auto row = result[result.size() - 1];
+                          auto ret = Person(row).toJson();
+                          ret["level"] = *level;
+                          auto resp = HttpResponse::newHttpJsonResponse(ret);
+                          resp->setStatusCode(HttpStatusCode::k200OK);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+
+                      std::string body;
+                      for (auto row : result) {
+                          auto ret = Person(row).toJson();
+                          ret["level"] = row["level"].as<int>();
+                          appendJsonElement(body, ret);
+                      }
+                      auto resp = newJsonArrayResponse(std::move(body));
+                      resp->setStatusCode(HttpStatusCode::k200OK);
+                      (*callbackPtr)(resp);
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
+}
+
+void PersonsController::getCommonManager(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId, int otherPersonId) const {
+    LOG_DEBUG << "getCommonManager personId: "<< personId << " otherPersonId: " << otherPersonId;
+
+    auto graph = drogon::app().getPlugin<OrgGraphPlugin>()->snapshot();
+    if (graph) {
+        auto a = graph->indexOf(personId);
+        auto b = graph->indexOf(otherPersonId);
+        auto manager = a == OrgGraph::npos || b == OrgGraph::npos ? OrgGraph::npos : graph->commonManager(a, b);
+        if (manager == OrgGraph::npos) {
+            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+            resp->setStatusCode(HttpStatusCode::k404NotFound);
+            callback(resp);
+            return;
+        }
+        auto resp = HttpResponse::newHttpJsonResponse(graph->person(manager).toJson());
+        resp->setStatusCode(HttpStatusCode::k200OK);
+        callback(resp);
+        return;
+    }
+
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
+    // walks both chains in one statement and keeps the lowest shared person
+    const char *sql = "with recursive chain as ( \n\
+                           select person.id, person.manager_id, 0 as level, person.id as origin, array[person.id] as path \n\
+                           from person where person.id in ($1, $2) \n\
+                           union all \n\
+                           select manager.id, manager.manager_id, chain.level + 1, chain.origin, chain.path || manager.id \n\
+                           from person as manager \n\
+                           join chain on manager.id = chain.manager_id \n\
+                           where manager.id <> all(chain.path) \n\
+                       ) \n\
+                       select person.* \n\
+                       from person \n\
+                       join chain as a on a.id = person.id and a.origin = $1 \n\
+                       join chain as b on b.id = person.id and b.origin = $2 \n\
+                       order by a.level \n\
+                       limit 1";
+
+    *dbClientPtr << std::string(sql)
+                 << personId
+                 << otherPersonId
+                 >> [callbackPtr](const Result &result)
+                   {
+                      if (result.empty()) {
+                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                          resp->setStatusCode(HttpStatusCode::k404NotFound);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+
+                      auto resp = HttpResponse::newHttpJsonResponse(Person(result[0]).toJson());
+                      resp->setStatusCode(HttpStatusCode::k200OK);
+                      (*callbackPtr)(resp);
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
+}
+
+void PersonsController::getIsUnder(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int personId, int managerId) const {
+    LOG_DEBUG << "getIsUnder personId: "<< personId << " managerId: " << managerId;
+
+    auto graph = drogon::app().getPlugin<OrgGraphPlugin>()->snapshot();
+    if (graph) {
+        auto index = graph->indexOf(personId);
+        auto manager = graph->indexOf(managerId);
+        if (index == OrgGraph::npos || manager == OrgGraph::npos) {
+            auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+            resp->setStatusCode(HttpStatusCode::k404NotFound);
+            callback(resp);
+            return;
+        }
+        Json::Value ret{};
+        ret["is_under"] = graph->isUnder(index, manager);
+        auto resp = HttpResponse::newHttpJsonResponse(ret);
+        resp->setStatusCode(HttpStatusCode::k200OK);
         callback(resp);
+        return;
     }
 
-    department.getPersons(dbClientPtr,
-      [callbackPtr](const std::vector<Person> persons) {
-          if (persons.empty()) {
-             auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
-             resp->setStatusCode(HttpStatusCode::k404NotFound);
-             (*callbackPtr)(resp);
-          } else {
-             Json::Value ret{};
-             for (auto p : persons) {
-                 ret.append(p.toJson());
-             }
-             auto resp = HttpResponse::newHttpJsonResponse(ret);
-             resp->setStatusCode(HttpStatusCode::k200OK);
-             (*callbackPtr)(resp);
-          }
-      },
-      [callbackPtr](const DrogonDbException &e) {
-          LOG_ERROR << e.base().what();
-          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
-          resp->setStatusCode(HttpStatusCode::k500InternalServerError);
-          (*callbackPtr)(resp);
-      });
+    auto callbackPtr = std::make_shared<std::function<void(const HttpResponsePtr &)>>(std::move(callback));
+    auto dbClientPtr = drogon::app().getPlugin<DbRouterPlugin>()->reader(req);
+    const char *sql = "with recursive chain as ( \n\
+                           select person.id, person.manager_id, array[person.id] as path \n\
+                           from person where person.id = $1 \n\
+                           union all \n\
+                           select manager.id, manager.manager_id, chain.path || manager.id \n\
+                           from person as manager \n\
+                           join chain on manager.id = chain.manager_id \n\
+                           where manager.id <> all(chain.path) \n\
+                       ) \n\
+                       select exists(select 1 from person where id = $1) \n\
+                              and exists(select 1 from person where id = $2) as found, \n\
+                              exists(select 1 from chain where id = $2 and id <> $1) as is_under";
+
+    *dbClientPtr << std::string(sql)
+                 << personId
+                 << managerId
+                 >> [callbackPtr](const Result &result)
+                   {
+                      if (!result[0]["found"].as<bool>()) {
+                          auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("resource not found"));
+                          resp->setStatusCode(HttpStatusCode::k404NotFound);
+                          (*callbackPtr)(resp);
+                          return;
+                      }
+
+                      Json::Value ret{};
+                      ret["is_under"] = result[0]["is_under"].as<bool>();
+                      auto resp = HttpResponse::newHttpJsonResponse(ret);
+                      resp->setStatusCode(HttpStatusCode::k200OK);
+                      (*callbackPtr)(resp);
+                   }
+                 >> [callbackPtr](const DrogonDbException &e)
+                   {
+                      LOG_ERROR << e.base().what();
+                      auto resp = HttpResponse::newHttpJsonResponse(makeErrResp("database error"));
+                      resp->setStatusCode(HttpStatusCode::k500InternalServerError);
+                      (*callbackPtr)(resp);
+                   };
 }
 
 PersonsController::PersonDetails::PersonDetails(const PersonInfo &personInfo) {
@@ -273,6 +1281,7 @@ PersonsController::PersonDetails::PersonDetails(const PersonInfo &personInfo) {
     jobJson["id"] = personInfo.getValueOfJobId();
     jobJson["title"] = personInfo.getValueOfJobTitle();
     this->job = jobJson;
+    headcount = drogon::app().getPlugin<OrgGraphPlugin>()->headcount(id);
 }
 
 auto PersonsController::PersonDetails::toJson() -> Json::Value {
@@ -284,5 +1293,6 @@ auto PersonsController::PersonDetails::toJson() -> Json::Value {
     ret["manager"] = manager;
     ret["department"] = department;
     ret["job"] = job;
+    ret["headcount"] = headcount < 0 ? Json::Value() : Json::Value(static_cast<Json::Int64>(headcount));
     return ret;
 }
@@ -14,17 +14,42 @@ class PersonsController : public drogon::HttpController<PersonsController> {
       ADD_METHOD_TO(PersonsController::get, "/persons", Get);
       ADD_METHOD_TO(PersonsController::getOne, "/persons/{1}", Get);
       ADD_METHOD_TO(PersonsController::createOne, "/persons", Post);
+      ADD_METHOD_TO(PersonsController::createBatch, "/persons:batch", Post, "LoginFilter");
+      ADD_METHOD_TO(PersonsController::importPersons, "/persons/import", Post, "LoginFilter");
+      ADD_METHOD_TO(PersonsController::exportPersons, "/persons/export", Get);
       ADD_METHOD_TO(PersonsController::updateOne, "/persons/{1}", Put);
       ADD_METHOD_TO(PersonsController::deleteOne, "/persons/{1}", Delete);
       ADD_METHOD_TO(PersonsController::getDirectReports, "/persons/{1}/reports", Get);
+      ADD_METHOD_TO(PersonsController::getSubtree, "/persons/{1}/subtree", Get);
+      ADD_METHOD_TO(PersonsController::getChain, "/persons/{1}/chain", Get);
+      ADD_METHOD_TO(PersonsController::getCommonManager, "/persons/{1}/common-manager/{2}", Get);
+      ADD_METHOD_TO(PersonsController::getIsUnder, "/persons/{1}/is-under/{2}", Get);
     METHOD_LIST_END
 
     void get(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback) const;
     void getOne(const HttpRequestPtr& req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
     void createOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, Person &&pPerson) const;
+    void createBatch(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+    void importPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+    void exportPersons(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
     void updateOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId, Person &&pPerson) const;
     void deleteOne(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
     void getDirectReports(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
+    void getSubtree(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
+    void getChain(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId) const;
+    void getCommonManager(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId, int pOtherPersonId) const;
+    void getIsUnder(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, int pPersonId, int pManagerId) const;
+
+    // list query for a whitelisted sort, nullptr if the pair is not allowed;
+    // afterCursor selects the keyset variant that resumes after a PageCursor
+    static auto listSql(const std::string &sortField, const std::string &sortOrder, bool afterCursor = false)
+        -> const std::string *;
+    // persons whose `column` is $1 with the list query's joins, left joined to
+    // a single row so that the trailing parent_exists flag (whether
+    // `parentTable` has a row with id $1) arrives even without members
+    static auto membersSql(const std::string &parentTable, const std::string &column) -> std::string;
+    // 404 without a parent, otherwise the members as person details
+    static auto membersResponse(const drogon::orm::Result &result) -> HttpResponsePtr;
 
  private:
     struct PersonDetails {
@@ -35,8 +60,14 @@ class PersonsController : public drogon::HttpController<PersonsController> {
         Json::Value manager;
         Json::Value department;
         Json::Value job;
+        int64_t headcount;
         PersonDetails() {}
         explicit PersonDetails(const PersonInfo &personInfo);
         Json::Value toJson();
     };
+
+    struct Export;
+    static void exportNextBatch(const std::shared_ptr<Export> &exp);
+    // GET /persons?ids=..., in the order asked for
+    static void getByIds(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback, const std::string &idList);
 };
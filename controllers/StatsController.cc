@@ -0,0 +1,11 @@
+#include "StatsController.h"
+#include "../plugins/DbRouterPlugin.h"
+#include "../plugins/ResultCachePlugin.h"
+
+void StatsController::get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const {
+    LOG_DEBUG << "get stats";
+    Json::Value ret;
+    ret["db"] = drogon::app().getPlugin<DbRouterPlugin>()->stats();
+    ret["cache"] = drogon::app().getPlugin<ResultCachePlugin>()->stats();
+    callback(HttpResponse::newHttpJsonResponse(ret));
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <drogon/HttpController.h>
+
+using namespace drogon;
+
+class StatsController : public drogon::HttpController<StatsController> {
+ public:
+    METHOD_LIST_BEGIN
+      ADD_METHOD_TO(StatsController::get, "/stats", Get, "LoginFilter");
+    METHOD_LIST_END
+
+    void get(const HttpRequestPtr &req, std::function<void(const HttpResponsePtr &)> &&callback) const;
+};
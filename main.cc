@@ -1,8 +1,28 @@
 #include <drogon/drogon.h>
+#include <fstream>
 
 int main() {
     LOG_DEBUG << "Load config file";
-    drogon::app().loadConfigFile("../config.json");
+    Json::Value config;
+    std::ifstream file("../config.json");
+    Json::CharReaderBuilder builder;
+    std::string errs;
+    if (!Json::parseFromStream(builder, file, &config, &errs)) {
+        LOG_FATAL << "cannot read ../config.json: " << errs;
+        return 1;
+    }
+    // drogon does not tell plugins how many connections a db client has;
+    // DbRouterPlugin needs it to size its pools
+    for (auto &plugin : config["plugins"]) {
+        if (plugin["name"].asString() != "DbRouterPlugin") {
+            continue;
+        }
+        for (const auto &client : config["db_clients"]) {
+            plugin["config"]["client_connections"][client.get("name", "default").asString()] =
+                client.get("number_of_connections", 1);
+        }
+    }
+    drogon::app().loadConfigJson(std::move(config));
 
     LOG_DEBUG << "running on localhost:3000";
     drogon::app().run();
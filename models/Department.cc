@@ -35,11 +35,11 @@ Department::Department(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["name"].isNull())
         {
-            name_=std::make_shared<std::string>(r["name"].as<std::string>());
+            name_.emplace(r["name"].as<std::string>());
         }
     }
     else
@@ -54,12 +54,12 @@ Department::Department(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            name_=std::make_shared<std::string>(r[index].as<std::string>());
+            name_.emplace(r[index].as<std::string>());
         }
     }
 
@@ -77,7 +77,7 @@ Department::Department(const Json::Value &pJson, const std::vector<std::string>
         dirtyFlag_[0] = true;
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -85,7 +85,7 @@ Department::Department(const Json::Value &pJson, const std::vector<std::string>
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            name_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            name_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -97,7 +97,7 @@ Department::Department(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[0]=true;
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("name"))
@@ -105,7 +105,7 @@ Department::Department(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1]=true;
         if(!pJson["name"].isNull())
         {
-            name_=std::make_shared<std::string>(pJson["name"].asString());
+            name_.emplace(pJson["name"].asString());
         }
     }
 }
@@ -122,7 +122,7 @@ void Department::updateByMasqueradedJson(const Json::Value &pJson,
     {
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -130,7 +130,7 @@ void Department::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            name_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            name_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -141,7 +141,7 @@ void Department::updateByJson(const Json::Value &pJson) noexcept(false)
     {
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("name"))
@@ -149,7 +149,7 @@ void Department::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1] = true;
         if(!pJson["name"].isNull())
         {
-            name_=std::make_shared<std::string>(pJson["name"].asString());
+            name_.emplace(pJson["name"].asString());
         }
     }
 }
@@ -161,13 +161,13 @@ const int32_t &Department::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Department::getId() const noexcept
+const int32_t *Department::getId() const noexcept
 {
-    return id_;
+    return id_ ? &*id_ : nullptr;
 }
 void Department::setId(const int32_t &pId) noexcept
 {
-    id_ = std::make_shared<int32_t>(pId);
+    id_.emplace(pId);
     dirtyFlag_[0] = true;
 }
 const typename Department::PrimaryKeyType & Department::getPrimaryKey() const
@@ -183,18 +183,18 @@ const std::string &Department::getValueOfName() const noexcept
         return *name_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &Department::getName() const noexcept
+const std::string *Department::getName() const noexcept
 {
-    return name_;
+    return name_ ? &*name_ : nullptr;
 }
 void Department::setName(const std::string &pName) noexcept
 {
-    name_ = std::make_shared<std::string>(pName);
+    name_.emplace(pName);
     dirtyFlag_[1] = true;
 }
 void Department::setName(std::string &&pName) noexcept
 {
-    name_ = std::make_shared<std::string>(std::move(pName));
+    name_.emplace(std::move(pName));
     dirtyFlag_[1] = true;
 }
 
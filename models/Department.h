@@ -15,6 +15,7 @@
 #include <drogon/orm/CoroMapper.h>
 #endif
 #include <trantor/utils/Date.h>
+#include <drogon/utils/optional.h>
 #include <trantor/utils/Logger.h>
 #include <json/json.h>
 #include <string>
@@ -99,16 +100,16 @@ class Department
     /**  For column id  */
     ///Get the value of the column id, returns the default value if the column is null
     const int32_t &getValueOfId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getId() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const int32_t *getId() const noexcept;
     ///Set the value of the column id
     void setId(const int32_t &pId) noexcept;
 
     /**  For column name  */
     ///Get the value of the column name, returns the default value if the column is null
     const std::string &getValueOfName() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<std::string> &getName() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const std::string *getName() const noexcept;
     ///Set the value of the column name
     void setName(const std::string &pName) noexcept;
     void setName(std::string &&pName) noexcept;
@@ -134,8 +135,8 @@ class Department
     void updateArgs(drogon::orm::internal::SqlBinder &binder) const;
     ///For mysql or sqlite3
     void updateId(const uint64_t id);
-    std::shared_ptr<int32_t> id_;
-    std::shared_ptr<std::string> name_;
+    drogon::optional<int32_t> id_;
+    drogon::optional<std::string> name_;
     struct MetaData
     {
         const std::string colName_;
@@ -35,11 +35,11 @@ Job::Job(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["title"].isNull())
         {
-            title_=std::make_shared<std::string>(r["title"].as<std::string>());
+            title_.emplace(r["title"].as<std::string>());
         }
     }
     else
@@ -54,12 +54,12 @@ Job::Job(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            title_=std::make_shared<std::string>(r[index].as<std::string>());
+            title_.emplace(r[index].as<std::string>());
         }
     }
 
@@ -77,7 +77,7 @@ Job::Job(const Json::Value &pJson, const std::vector<std::string> &pMasquerading
         dirtyFlag_[0] = true;
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -85,7 +85,7 @@ Job::Job(const Json::Value &pJson, const std::vector<std::string> &pMasquerading
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            title_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            title_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -97,7 +97,7 @@ Job::Job(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[0]=true;
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("title"))
@@ -105,7 +105,7 @@ Job::Job(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1]=true;
         if(!pJson["title"].isNull())
         {
-            title_=std::make_shared<std::string>(pJson["title"].asString());
+            title_.emplace(pJson["title"].asString());
         }
     }
 }
@@ -122,7 +122,7 @@ void Job::updateByMasqueradedJson(const Json::Value &pJson,
     {
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -130,7 +130,7 @@ void Job::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            title_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            title_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
 }
@@ -141,7 +141,7 @@ void Job::updateByJson(const Json::Value &pJson) noexcept(false)
     {
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("title"))
@@ -149,7 +149,7 @@ void Job::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1] = true;
         if(!pJson["title"].isNull())
         {
-            title_=std::make_shared<std::string>(pJson["title"].asString());
+            title_.emplace(pJson["title"].asString());
         }
     }
 }
@@ -161,13 +161,13 @@ const int32_t &Job::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Job::getId() const noexcept
+const int32_t *Job::getId() const noexcept
 {
-    return id_;
+    return id_ ? &*id_ : nullptr;
 }
 void Job::setId(const int32_t &pId) noexcept
 {
-    id_ = std::make_shared<int32_t>(pId);
+    id_.emplace(pId);
     dirtyFlag_[0] = true;
 }
 const typename Job::PrimaryKeyType & Job::getPrimaryKey() const
@@ -183,18 +183,18 @@ const std::string &Job::getValueOfTitle() const noexcept
         return *title_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &Job::getTitle() const noexcept
+const std::string *Job::getTitle() const noexcept
 {
-    return title_;
+    return title_ ? &*title_ : nullptr;
 }
 void Job::setTitle(const std::string &pTitle) noexcept
 {
-    title_ = std::make_shared<std::string>(pTitle);
+    title_.emplace(pTitle);
     dirtyFlag_[1] = true;
 }
 void Job::setTitle(std::string &&pTitle) noexcept
 {
-    title_ = std::make_shared<std::string>(std::move(pTitle));
+    title_.emplace(std::move(pTitle));
     dirtyFlag_[1] = true;
 }
 
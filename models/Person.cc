@@ -46,27 +46,27 @@ Person::Person(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["job_id"].isNull())
         {
-            jobId_=std::make_shared<int32_t>(r["job_id"].as<int32_t>());
+            jobId_.emplace(r["job_id"].as<int32_t>());
         }
         if(!r["department_id"].isNull())
         {
-            departmentId_=std::make_shared<int32_t>(r["department_id"].as<int32_t>());
+            departmentId_.emplace(r["department_id"].as<int32_t>());
         }
         if(!r["manager_id"].isNull())
         {
-            managerId_=std::make_shared<int32_t>(r["manager_id"].as<int32_t>());
+            managerId_.emplace(r["manager_id"].as<int32_t>());
         }
         if(!r["first_name"].isNull())
         {
-            firstName_=std::make_shared<std::string>(r["first_name"].as<std::string>());
+            firstName_.emplace(r["first_name"].as<std::string>());
         }
         if(!r["last_name"].isNull())
         {
-            lastName_=std::make_shared<std::string>(r["last_name"].as<std::string>());
+            lastName_.emplace(r["last_name"].as<std::string>());
         }
         if(!r["hire_date"].isNull())
         {
@@ -75,7 +75,7 @@ Person::Person(const Row &r, const ssize_t indexOffset) noexcept
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
     else
@@ -90,32 +90,32 @@ Person::Person(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            jobId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            jobId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 2;
         if(!r[index].isNull())
         {
-            departmentId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            departmentId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 3;
         if(!r[index].isNull())
         {
-            managerId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            managerId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 4;
         if(!r[index].isNull())
         {
-            firstName_=std::make_shared<std::string>(r[index].as<std::string>());
+            firstName_.emplace(r[index].as<std::string>());
         }
         index = offset + 5;
         if(!r[index].isNull())
         {
-            lastName_=std::make_shared<std::string>(r[index].as<std::string>());
+            lastName_.emplace(r[index].as<std::string>());
         }
         index = offset + 6;
         if(!r[index].isNull())
@@ -125,7 +125,7 @@ Person::Person(const Row &r, const ssize_t indexOffset) noexcept
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
 
@@ -143,7 +143,7 @@ Person::Person(const Json::Value &pJson, const std::vector<std::string> &pMasque
         dirtyFlag_[0] = true;
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -151,7 +151,7 @@ Person::Person(const Json::Value &pJson, const std::vector<std::string> &pMasque
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            jobId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[1]].asInt64());
+            jobId_.emplace((int32_t)pJson[pMasqueradingVector[1]].asInt64());
         }
     }
     if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
@@ -159,7 +159,7 @@ Person::Person(const Json::Value &pJson, const std::vector<std::string> &pMasque
         dirtyFlag_[2] = true;
         if(!pJson[pMasqueradingVector[2]].isNull())
         {
-            departmentId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[2]].asInt64());
+            departmentId_.emplace((int32_t)pJson[pMasqueradingVector[2]].asInt64());
         }
     }
     if(!pMasqueradingVector[3].empty() && pJson.isMember(pMasqueradingVector[3]))
@@ -167,7 +167,7 @@ Person::Person(const Json::Value &pJson, const std::vector<std::string> &pMasque
         dirtyFlag_[3] = true;
         if(!pJson[pMasqueradingVector[3]].isNull())
         {
-            managerId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[3]].asInt64());
+            managerId_.emplace((int32_t)pJson[pMasqueradingVector[3]].asInt64());
         }
     }
     if(!pMasqueradingVector[4].empty() && pJson.isMember(pMasqueradingVector[4]))
@@ -175,7 +175,7 @@ Person::Person(const Json::Value &pJson, const std::vector<std::string> &pMasque
         dirtyFlag_[4] = true;
         if(!pJson[pMasqueradingVector[4]].isNull())
         {
-            firstName_=std::make_shared<std::string>(pJson[pMasqueradingVector[4]].asString());
+            firstName_.emplace(pJson[pMasqueradingVector[4]].asString());
         }
     }
     if(!pMasqueradingVector[5].empty() && pJson.isMember(pMasqueradingVector[5]))
@@ -183,7 +183,7 @@ Person::Person(const Json::Value &pJson, const std::vector<std::string> &pMasque
         dirtyFlag_[5] = true;
         if(!pJson[pMasqueradingVector[5]].isNull())
         {
-            lastName_=std::make_shared<std::string>(pJson[pMasqueradingVector[5]].asString());
+            lastName_.emplace(pJson[pMasqueradingVector[5]].asString());
         }
     }
     if(!pMasqueradingVector[6].empty() && pJson.isMember(pMasqueradingVector[6]))
@@ -196,7 +196,7 @@ Person::Person(const Json::Value &pJson, const std::vector<std::string> &pMasque
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
 }
@@ -208,7 +208,7 @@ Person::Person(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[0]=true;
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("job_id"))
@@ -216,7 +216,7 @@ Person::Person(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1]=true;
         if(!pJson["job_id"].isNull())
         {
-            jobId_=std::make_shared<int32_t>((int32_t)pJson["job_id"].asInt64());
+            jobId_.emplace((int32_t)pJson["job_id"].asInt64());
         }
     }
     if(pJson.isMember("department_id"))
@@ -224,7 +224,7 @@ Person::Person(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[2]=true;
         if(!pJson["department_id"].isNull())
         {
-            departmentId_=std::make_shared<int32_t>((int32_t)pJson["department_id"].asInt64());
+            departmentId_.emplace((int32_t)pJson["department_id"].asInt64());
         }
     }
     if(pJson.isMember("manager_id"))
@@ -232,7 +232,7 @@ Person::Person(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[3]=true;
         if(!pJson["manager_id"].isNull())
         {
-            managerId_=std::make_shared<int32_t>((int32_t)pJson["manager_id"].asInt64());
+            managerId_.emplace((int32_t)pJson["manager_id"].asInt64());
         }
     }
     if(pJson.isMember("first_name"))
@@ -240,7 +240,7 @@ Person::Person(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[4]=true;
         if(!pJson["first_name"].isNull())
         {
-            firstName_=std::make_shared<std::string>(pJson["first_name"].asString());
+            firstName_.emplace(pJson["first_name"].asString());
         }
     }
     if(pJson.isMember("last_name"))
@@ -248,7 +248,7 @@ Person::Person(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[5]=true;
         if(!pJson["last_name"].isNull())
         {
-            lastName_=std::make_shared<std::string>(pJson["last_name"].asString());
+            lastName_.emplace(pJson["last_name"].asString());
         }
     }
     if(pJson.isMember("hire_date"))
@@ -261,7 +261,7 @@ Person::Person(const Json::Value &pJson) noexcept(false)
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
 }
@@ -278,7 +278,7 @@ void Person::updateByMasqueradedJson(const Json::Value &pJson,
     {
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -286,7 +286,7 @@ void Person::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            jobId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[1]].asInt64());
+            jobId_.emplace((int32_t)pJson[pMasqueradingVector[1]].asInt64());
         }
     }
     if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
@@ -294,7 +294,7 @@ void Person::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[2] = true;
         if(!pJson[pMasqueradingVector[2]].isNull())
         {
-            departmentId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[2]].asInt64());
+            departmentId_.emplace((int32_t)pJson[pMasqueradingVector[2]].asInt64());
         }
     }
     if(!pMasqueradingVector[3].empty() && pJson.isMember(pMasqueradingVector[3]))
@@ -302,7 +302,7 @@ void Person::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[3] = true;
         if(!pJson[pMasqueradingVector[3]].isNull())
         {
-            managerId_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[3]].asInt64());
+            managerId_.emplace((int32_t)pJson[pMasqueradingVector[3]].asInt64());
         }
     }
     if(!pMasqueradingVector[4].empty() && pJson.isMember(pMasqueradingVector[4]))
@@ -310,7 +310,7 @@ void Person::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[4] = true;
         if(!pJson[pMasqueradingVector[4]].isNull())
         {
-            firstName_=std::make_shared<std::string>(pJson[pMasqueradingVector[4]].asString());
+            firstName_.emplace(pJson[pMasqueradingVector[4]].asString());
         }
     }
     if(!pMasqueradingVector[5].empty() && pJson.isMember(pMasqueradingVector[5]))
@@ -318,7 +318,7 @@ void Person::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[5] = true;
         if(!pJson[pMasqueradingVector[5]].isNull())
         {
-            lastName_=std::make_shared<std::string>(pJson[pMasqueradingVector[5]].asString());
+            lastName_.emplace(pJson[pMasqueradingVector[5]].asString());
         }
     }
     if(!pMasqueradingVector[6].empty() && pJson.isMember(pMasqueradingVector[6]))
@@ -331,7 +331,7 @@ void Person::updateByMasqueradedJson(const Json::Value &pJson,
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
 }
@@ -342,7 +342,7 @@ void Person::updateByJson(const Json::Value &pJson) noexcept(false)
     {
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("job_id"))
@@ -350,7 +350,7 @@ void Person::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1] = true;
         if(!pJson["job_id"].isNull())
         {
-            jobId_=std::make_shared<int32_t>((int32_t)pJson["job_id"].asInt64());
+            jobId_.emplace((int32_t)pJson["job_id"].asInt64());
         }
     }
     if(pJson.isMember("department_id"))
@@ -358,7 +358,7 @@ void Person::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[2] = true;
         if(!pJson["department_id"].isNull())
         {
-            departmentId_=std::make_shared<int32_t>((int32_t)pJson["department_id"].asInt64());
+            departmentId_.emplace((int32_t)pJson["department_id"].asInt64());
         }
     }
     if(pJson.isMember("manager_id"))
@@ -366,7 +366,7 @@ void Person::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[3] = true;
         if(!pJson["manager_id"].isNull())
         {
-            managerId_=std::make_shared<int32_t>((int32_t)pJson["manager_id"].asInt64());
+            managerId_.emplace((int32_t)pJson["manager_id"].asInt64());
         }
     }
     if(pJson.isMember("first_name"))
@@ -374,7 +374,7 @@ void Person::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[4] = true;
         if(!pJson["first_name"].isNull())
         {
-            firstName_=std::make_shared<std::string>(pJson["first_name"].asString());
+            firstName_.emplace(pJson["first_name"].asString());
         }
     }
     if(pJson.isMember("last_name"))
@@ -382,7 +382,7 @@ void Person::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[5] = true;
         if(!pJson["last_name"].isNull())
         {
-            lastName_=std::make_shared<std::string>(pJson["last_name"].asString());
+            lastName_.emplace(pJson["last_name"].asString());
         }
     }
     if(pJson.isMember("hire_date"))
@@ -395,7 +395,7 @@ void Person::updateByJson(const Json::Value &pJson) noexcept(false)
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
 }
@@ -407,13 +407,13 @@ const int32_t &Person::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Person::getId() const noexcept
+const int32_t *Person::getId() const noexcept
 {
-    return id_;
+    return id_ ? &*id_ : nullptr;
 }
 void Person::setId(const int32_t &pId) noexcept
 {
-    id_ = std::make_shared<int32_t>(pId);
+    id_.emplace(pId);
     dirtyFlag_[0] = true;
 }
 const typename Person::PrimaryKeyType & Person::getPrimaryKey() const
@@ -429,13 +429,13 @@ const int32_t &Person::getValueOfJobId() const noexcept
         return *jobId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Person::getJobId() const noexcept
+const int32_t *Person::getJobId() const noexcept
 {
-    return jobId_;
+    return jobId_ ? &*jobId_ : nullptr;
 }
 void Person::setJobId(const int32_t &pJobId) noexcept
 {
-    jobId_ = std::make_shared<int32_t>(pJobId);
+    jobId_.emplace(pJobId);
     dirtyFlag_[1] = true;
 }
 
@@ -446,13 +446,13 @@ const int32_t &Person::getValueOfDepartmentId() const noexcept
         return *departmentId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Person::getDepartmentId() const noexcept
+const int32_t *Person::getDepartmentId() const noexcept
 {
-    return departmentId_;
+    return departmentId_ ? &*departmentId_ : nullptr;
 }
 void Person::setDepartmentId(const int32_t &pDepartmentId) noexcept
 {
-    departmentId_ = std::make_shared<int32_t>(pDepartmentId);
+    departmentId_.emplace(pDepartmentId);
     dirtyFlag_[2] = true;
 }
 
@@ -463,13 +463,13 @@ const int32_t &Person::getValueOfManagerId() const noexcept
         return *managerId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &Person::getManagerId() const noexcept
+const int32_t *Person::getManagerId() const noexcept
 {
-    return managerId_;
+    return managerId_ ? &*managerId_ : nullptr;
 }
 void Person::setManagerId(const int32_t &pManagerId) noexcept
 {
-    managerId_ = std::make_shared<int32_t>(pManagerId);
+    managerId_.emplace(pManagerId);
     dirtyFlag_[3] = true;
 }
 
@@ -480,18 +480,18 @@ const std::string &Person::getValueOfFirstName() const noexcept
         return *firstName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &Person::getFirstName() const noexcept
+const std::string *Person::getFirstName() const noexcept
 {
-    return firstName_;
+    return firstName_ ? &*firstName_ : nullptr;
 }
 void Person::setFirstName(const std::string &pFirstName) noexcept
 {
-    firstName_ = std::make_shared<std::string>(pFirstName);
+    firstName_.emplace(pFirstName);
     dirtyFlag_[4] = true;
 }
 void Person::setFirstName(std::string &&pFirstName) noexcept
 {
-    firstName_ = std::make_shared<std::string>(std::move(pFirstName));
+    firstName_.emplace(std::move(pFirstName));
     dirtyFlag_[4] = true;
 }
 
@@ -502,18 +502,18 @@ const std::string &Person::getValueOfLastName() const noexcept
         return *lastName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &Person::getLastName() const noexcept
+const std::string *Person::getLastName() const noexcept
 {
-    return lastName_;
+    return lastName_ ? &*lastName_ : nullptr;
 }
 void Person::setLastName(const std::string &pLastName) noexcept
 {
-    lastName_ = std::make_shared<std::string>(pLastName);
+    lastName_.emplace(pLastName);
     dirtyFlag_[5] = true;
 }
 void Person::setLastName(std::string &&pLastName) noexcept
 {
-    lastName_ = std::make_shared<std::string>(std::move(pLastName));
+    lastName_.emplace(std::move(pLastName));
     dirtyFlag_[5] = true;
 }
 
@@ -524,13 +524,13 @@ const ::trantor::Date &Person::getValueOfHireDate() const noexcept
         return *hireDate_;
     return defaultValue;
 }
-const std::shared_ptr<::trantor::Date> &Person::getHireDate() const noexcept
+const ::trantor::Date *Person::getHireDate() const noexcept
 {
-    return hireDate_;
+    return hireDate_ ? &*hireDate_ : nullptr;
 }
 void Person::setHireDate(const ::trantor::Date &pHireDate) noexcept
 {
-    hireDate_ = std::make_shared<::trantor::Date>(pHireDate.roundDay());
+    hireDate_.emplace(pHireDate.roundDay());
     dirtyFlag_[6] = true;
 }
 
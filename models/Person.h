@@ -15,6 +15,7 @@
 #include <drogon/orm/CoroMapper.h>
 #endif
 #include <trantor/utils/Date.h>
+#include <drogon/utils/optional.h>
 #include <trantor/utils/Logger.h>
 #include <json/json.h>
 #include <string>
@@ -106,40 +107,40 @@ class Person
     /**  For column id  */
     ///Get the value of the column id, returns the default value if the column is null
     const int32_t &getValueOfId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getId() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const int32_t *getId() const noexcept;
     ///Set the value of the column id
     void setId(const int32_t &pId) noexcept;
 
     /**  For column job_id  */
     ///Get the value of the column job_id, returns the default value if the column is null
     const int32_t &getValueOfJobId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getJobId() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const int32_t *getJobId() const noexcept;
     ///Set the value of the column job_id
     void setJobId(const int32_t &pJobId) noexcept;
 
     /**  For column department_id  */
     ///Get the value of the column department_id, returns the default value if the column is null
     const int32_t &getValueOfDepartmentId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getDepartmentId() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const int32_t *getDepartmentId() const noexcept;
     ///Set the value of the column department_id
     void setDepartmentId(const int32_t &pDepartmentId) noexcept;
 
     /**  For column manager_id  */
     ///Get the value of the column manager_id, returns the default value if the column is null
     const int32_t &getValueOfManagerId() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<int32_t> &getManagerId() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const int32_t *getManagerId() const noexcept;
     ///Set the value of the column manager_id
     void setManagerId(const int32_t &pManagerId) noexcept;
 
     /**  For column first_name  */
     ///Get the value of the column first_name, returns the default value if the column is null
     const std::string &getValueOfFirstName() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<std::string> &getFirstName() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const std::string *getFirstName() const noexcept;
     ///Set the value of the column first_name
     void setFirstName(const std::string &pFirstName) noexcept;
     void setFirstName(std::string &&pFirstName) noexcept;
@@ -147,8 +148,8 @@ class Person
     /**  For column last_name  */
     ///Get the value of the column last_name, returns the default value if the column is null
     const std::string &getValueOfLastName() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<std::string> &getLastName() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const std::string *getLastName() const noexcept;
     ///Set the value of the column last_name
     void setLastName(const std::string &pLastName) noexcept;
     void setLastName(std::string &&pLastName) noexcept;
@@ -156,8 +157,8 @@ class Person
     /**  For column hire_date  */
     ///Get the value of the column hire_date, returns the default value if the column is null
     const ::trantor::Date &getValueOfHireDate() const noexcept;
-    ///Return a shared_ptr object pointing to the column const value, or an empty shared_ptr object if the column is null
-    const std::shared_ptr<::trantor::Date> &getHireDate() const noexcept;
+    ///Return a pointer to the column const value, or nullptr if the column is null
+    const ::trantor::Date *getHireDate() const noexcept;
     ///Set the value of the column hire_date
     void setHireDate(const ::trantor::Date &pHireDate) noexcept;
 
@@ -188,13 +189,13 @@ class Person
     void updateArgs(drogon::orm::internal::SqlBinder &binder) const;
     ///For mysql or sqlite3
     void updateId(const uint64_t id);
-    std::shared_ptr<int32_t> id_;
-    std::shared_ptr<int32_t> jobId_;
-    std::shared_ptr<int32_t> departmentId_;
-    std::shared_ptr<int32_t> managerId_;
-    std::shared_ptr<std::string> firstName_;
-    std::shared_ptr<std::string> lastName_;
-    std::shared_ptr<::trantor::Date> hireDate_;
+    drogon::optional<int32_t> id_;
+    drogon::optional<int32_t> jobId_;
+    drogon::optional<int32_t> departmentId_;
+    drogon::optional<int32_t> managerId_;
+    drogon::optional<std::string> firstName_;
+    drogon::optional<std::string> lastName_;
+    drogon::optional<::trantor::Date> hireDate_;
     struct MetaData
     {
         const std::string colName_;
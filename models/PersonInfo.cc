@@ -1,7 +1,9 @@
 #include "PersonInfo.h"
 #include "Department.h"
 #include "Job.h"
+#include <drogon/orm/Exception.h>
 #include <string>
+#include <cstring>
 
 using namespace drogon;
 using namespace drogon::orm;
@@ -13,39 +15,39 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["job_id"].isNull())
         {
-            jobId_=std::make_shared<int32_t>(r["job_id"].as<int32_t>());
+            jobId_.emplace(r["job_id"].as<int32_t>());
         }
         if(!r["job_title"].isNull())
         {
-            jobTitle_=std::make_shared<std::string>(r["job_title"].as<std::string>());
+            jobTitle_.emplace(r["job_title"].as<std::string>());
         }
         if(!r["department_id"].isNull())
         {
-            departmentId_=std::make_shared<int32_t>(r["department_id"].as<int32_t>());
+            departmentId_.emplace(r["department_id"].as<int32_t>());
         }
         if(!r["department_name"].isNull())
         {
-            departmentName_=std::make_shared<std::string>(r["department_name"].as<std::string>());
+            departmentName_.emplace(r["department_name"].as<std::string>());
         }
         if(!r["manager_id"].isNull())
         {
-            managerId_=std::make_shared<int32_t>(r["manager_id"].as<int32_t>());
+            managerId_.emplace(r["manager_id"].as<int32_t>());
         }
         if(!r["manager_full_name"].isNull())
         {
-            managerFullName_=std::make_shared<std::string>(r["manager_full_name"].as<std::string>());
+            managerFullName_.emplace(r["manager_full_name"].as<std::string>());
         }
         if(!r["first_name"].isNull())
         {
-            firstName_=std::make_shared<std::string>(r["first_name"].as<std::string>());
+            firstName_.emplace(r["first_name"].as<std::string>());
         }
         if(!r["last_name"].isNull())
         {
-            lastName_=std::make_shared<std::string>(r["last_name"].as<std::string>());
+            lastName_.emplace(r["last_name"].as<std::string>());
         }
         if(!r["hire_date"].isNull())
         {
@@ -54,7 +56,7 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
     }
     else
@@ -69,32 +71,32 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            jobId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            jobId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 2;
         if(!r[index].isNull())
         {
-            departmentId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            departmentId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 3;
         if(!r[index].isNull())
         {
-            managerId_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            managerId_.emplace(r[index].as<int32_t>());
         }
         index = offset + 4;
         if(!r[index].isNull())
         {
-            firstName_=std::make_shared<std::string>(r[index].as<std::string>());
+            firstName_.emplace(r[index].as<std::string>());
         }
         index = offset + 5;
         if(!r[index].isNull())
         {
-            lastName_=std::make_shared<std::string>(r[index].as<std::string>());
+            lastName_.emplace(r[index].as<std::string>());
         }
         index = offset + 6;
         if(!r[index].isNull())
@@ -104,27 +106,103 @@ PersonInfo::PersonInfo(const Row &r, const ssize_t indexOffset) noexcept
             memset(&stm,0,sizeof(stm));
             strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
             time_t t = mktime(&stm);
-            hireDate_=std::make_shared<::trantor::Date>(t*1000000);
+            hireDate_.emplace(t*1000000);
         }
         index = offset + 7;
         if(!r[index].isNull())
         {
-            jobTitle_=std::make_shared<std::string>(r[index].as<std::string>());
+            jobTitle_.emplace(r[index].as<std::string>());
         }
         index = offset + 8;
         if(!r[index].isNull())
         {
-            departmentName_=std::make_shared<std::string>(r[index].as<std::string>());
+            departmentName_.emplace(r[index].as<std::string>());
         }
         index = offset + 9;
         if(!r[index].isNull())
         {
-            managerFullName_=std::make_shared<std::string>(r[index].as<std::string>());
+            managerFullName_.emplace(r[index].as<std::string>());
         }
     }
 
 }
 
+PersonInfo::Columns PersonInfo::columnsOf(const Result &r)
+{
+    static const char *names[] = {
+        "id",
+        "job_id",
+        "department_id",
+        "manager_id",
+        "first_name",
+        "last_name",
+        "hire_date",
+        "job_title",
+        "department_name",
+        "manager_full_name"
+    };
+    Columns columns;
+    for(size_t i = 0; i < columns.size(); ++i)
+    {
+        Row::SizeType c = 0;
+        while(c < r.columns() && strcmp(r.columnName(c), names[i]) != 0)
+            ++c;
+        if(c == r.columns())
+            throw RangeError(std::string("there is no column named ") + names[i]);
+        columns[i] = c;
+    }
+    return columns;
+}
+
+PersonInfo::PersonInfo(const Row &r, const Columns &columns) noexcept
+{
+    if(!r[columns[0]].isNull())
+    {
+        id_.emplace(r[columns[0]].as<int32_t>());
+    }
+    if(!r[columns[1]].isNull())
+    {
+        jobId_.emplace(r[columns[1]].as<int32_t>());
+    }
+    if(!r[columns[2]].isNull())
+    {
+        departmentId_.emplace(r[columns[2]].as<int32_t>());
+    }
+    if(!r[columns[3]].isNull())
+    {
+        managerId_.emplace(r[columns[3]].as<int32_t>());
+    }
+    if(!r[columns[4]].isNull())
+    {
+        firstName_.emplace(r[columns[4]].as<std::string>());
+    }
+    if(!r[columns[5]].isNull())
+    {
+        lastName_.emplace(r[columns[5]].as<std::string>());
+    }
+    if(!r[columns[6]].isNull())
+    {
+        auto daysStr = r[columns[6]].as<std::string>();
+        struct tm stm;
+        memset(&stm,0,sizeof(stm));
+        strptime(daysStr.c_str(),"%Y-%m-%d",&stm);
+        time_t t = mktime(&stm);
+        hireDate_.emplace(t*1000000);
+    }
+    if(!r[columns[7]].isNull())
+    {
+        jobTitle_.emplace(r[columns[7]].as<std::string>());
+    }
+    if(!r[columns[8]].isNull())
+    {
+        departmentName_.emplace(r[columns[8]].as<std::string>());
+    }
+    if(!r[columns[9]].isNull())
+    {
+        managerFullName_.emplace(r[columns[9]].as<std::string>());
+    }
+}
+
 const int32_t &PersonInfo::getValueOfId() const noexcept
 {
     const static int32_t defaultValue = int32_t();
@@ -132,9 +210,9 @@ const int32_t &PersonInfo::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getId() const noexcept
+const int32_t *PersonInfo::getId() const noexcept
 {
-    return id_;
+    return id_ ? &*id_ : nullptr;
 }
 
 const int32_t &PersonInfo::getValueOfJobId() const noexcept
@@ -144,9 +222,9 @@ const int32_t &PersonInfo::getValueOfJobId() const noexcept
         return *jobId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getJobId() const noexcept
+const int32_t *PersonInfo::getJobId() const noexcept
 {
-    return jobId_;
+    return jobId_ ? &*jobId_ : nullptr;
 }
 
 const std::string &PersonInfo::getValueOfJobTitle() const noexcept
@@ -156,9 +234,9 @@ const std::string &PersonInfo::getValueOfJobTitle() const noexcept
         return *jobTitle_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getJobTitle() const noexcept
+const std::string *PersonInfo::getJobTitle() const noexcept
 {
-    return jobTitle_;
+    return jobTitle_ ? &*jobTitle_ : nullptr;
 }
 
 const int32_t &PersonInfo::getValueOfDepartmentId() const noexcept
@@ -168,9 +246,9 @@ const int32_t &PersonInfo::getValueOfDepartmentId() const noexcept
         return *departmentId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getDepartmentId() const noexcept
+const int32_t *PersonInfo::getDepartmentId() const noexcept
 {
-    return departmentId_;
+    return departmentId_ ? &*departmentId_ : nullptr;
 }
 
 const std::string &PersonInfo::getValueOfDepartmentName() const noexcept
@@ -180,9 +258,9 @@ const std::string &PersonInfo::getValueOfDepartmentName() const noexcept
         return *departmentName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getDepartmentName() const noexcept
+const std::string *PersonInfo::getDepartmentName() const noexcept
 {
-    return departmentName_;
+    return departmentName_ ? &*departmentName_ : nullptr;
 }
 
 const int32_t &PersonInfo::getValueOfManagerId() const noexcept
@@ -192,9 +270,9 @@ const int32_t &PersonInfo::getValueOfManagerId() const noexcept
         return *managerId_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &PersonInfo::getManagerId() const noexcept
+const int32_t *PersonInfo::getManagerId() const noexcept
 {
-    return managerId_;
+    return managerId_ ? &*managerId_ : nullptr;
 }
 
 const std::string &PersonInfo::getValueOfManagerFullName() const noexcept
@@ -204,9 +282,9 @@ const std::string &PersonInfo::getValueOfManagerFullName() const noexcept
         return *managerFullName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getManagerFullName() const noexcept
+const std::string *PersonInfo::getManagerFullName() const noexcept
 {
-    return managerFullName_;
+    return managerFullName_ ? &*managerFullName_ : nullptr;
 }
 
 const std::string &PersonInfo::getValueOfFirstName() const noexcept
@@ -216,9 +294,9 @@ const std::string &PersonInfo::getValueOfFirstName() const noexcept
         return *firstName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getFirstName() const noexcept
+const std::string *PersonInfo::getFirstName() const noexcept
 {
-    return firstName_;
+    return firstName_ ? &*firstName_ : nullptr;
 }
 
 const std::string &PersonInfo::getValueOfLastName() const noexcept
@@ -228,9 +306,9 @@ const std::string &PersonInfo::getValueOfLastName() const noexcept
         return *lastName_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &PersonInfo::getLastName() const noexcept
+const std::string *PersonInfo::getLastName() const noexcept
 {
-    return lastName_;
+    return lastName_ ? &*lastName_ : nullptr;
 }
 
 const ::trantor::Date &PersonInfo::getValueOfHireDate() const noexcept
@@ -240,9 +318,9 @@ const ::trantor::Date &PersonInfo::getValueOfHireDate() const noexcept
         return *hireDate_;
     return defaultValue;
 }
-const std::shared_ptr<::trantor::Date> &PersonInfo::getHireDate() const noexcept
+const ::trantor::Date *PersonInfo::getHireDate() const noexcept
 {
-    return hireDate_;
+    return hireDate_ ? &*hireDate_ : nullptr;
 }
 
 Json::Value PersonInfo::toJson() const
@@ -36,15 +36,15 @@ User::User(const Row &r, const ssize_t indexOffset) noexcept
     {
         if(!r["id"].isNull())
         {
-            id_=std::make_shared<int32_t>(r["id"].as<int32_t>());
+            id_.emplace(r["id"].as<int32_t>());
         }
         if(!r["username"].isNull())
         {
-            username_=std::make_shared<std::string>(r["username"].as<std::string>());
+            username_.emplace(r["username"].as<std::string>());
         }
         if(!r["password"].isNull())
         {
-            password_=std::make_shared<std::string>(r["password"].as<std::string>());
+            password_.emplace(r["password"].as<std::string>());
         }
     }
     else
@@ -59,17 +59,17 @@ User::User(const Row &r, const ssize_t indexOffset) noexcept
         index = offset + 0;
         if(!r[index].isNull())
         {
-            id_=std::make_shared<int32_t>(r[index].as<int32_t>());
+            id_.emplace(r[index].as<int32_t>());
         }
         index = offset + 1;
         if(!r[index].isNull())
         {
-            username_=std::make_shared<std::string>(r[index].as<std::string>());
+            username_.emplace(r[index].as<std::string>());
         }
         index = offset + 2;
         if(!r[index].isNull())
         {
-            password_=std::make_shared<std::string>(r[index].as<std::string>());
+            password_.emplace(r[index].as<std::string>());
         }
     }
 
@@ -87,7 +87,7 @@ User::User(const Json::Value &pJson, const std::vector<std::string> &pMasqueradi
         dirtyFlag_[0] = true;
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -95,7 +95,7 @@ User::User(const Json::Value &pJson, const std::vector<std::string> &pMasqueradi
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            username_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            username_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
     if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
@@ -103,7 +103,7 @@ User::User(const Json::Value &pJson, const std::vector<std::string> &pMasqueradi
         dirtyFlag_[2] = true;
         if(!pJson[pMasqueradingVector[2]].isNull())
         {
-            password_=std::make_shared<std::string>(pJson[pMasqueradingVector[2]].asString());
+            password_.emplace(pJson[pMasqueradingVector[2]].asString());
         }
     }
 }
@@ -115,7 +115,7 @@ User::User(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[0]=true;
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("username"))
@@ -123,7 +123,7 @@ User::User(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1]=true;
         if(!pJson["username"].isNull())
         {
-            username_=std::make_shared<std::string>(pJson["username"].asString());
+            username_.emplace(pJson["username"].asString());
         }
     }
     if(pJson.isMember("password"))
@@ -131,7 +131,7 @@ User::User(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[2]=true;
         if(!pJson["password"].isNull())
         {
-            password_=std::make_shared<std::string>(pJson["password"].asString());
+            password_.emplace(pJson["password"].asString());
         }
     }
 }
@@ -148,7 +148,7 @@ void User::updateByMasqueradedJson(const Json::Value &pJson,
     {
         if(!pJson[pMasqueradingVector[0]].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson[pMasqueradingVector[0]].asInt64());
+            id_.emplace((int32_t)pJson[pMasqueradingVector[0]].asInt64());
         }
     }
     if(!pMasqueradingVector[1].empty() && pJson.isMember(pMasqueradingVector[1]))
@@ -156,7 +156,7 @@ void User::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[1] = true;
         if(!pJson[pMasqueradingVector[1]].isNull())
         {
-            username_=std::make_shared<std::string>(pJson[pMasqueradingVector[1]].asString());
+            username_.emplace(pJson[pMasqueradingVector[1]].asString());
         }
     }
     if(!pMasqueradingVector[2].empty() && pJson.isMember(pMasqueradingVector[2]))
@@ -164,7 +164,7 @@ void User::updateByMasqueradedJson(const Json::Value &pJson,
         dirtyFlag_[2] = true;
         if(!pJson[pMasqueradingVector[2]].isNull())
         {
-            password_=std::make_shared<std::string>(pJson[pMasqueradingVector[2]].asString());
+            password_.emplace(pJson[pMasqueradingVector[2]].asString());
         }
     }
 }
@@ -175,7 +175,7 @@ void User::updateByJson(const Json::Value &pJson) noexcept(false)
     {
         if(!pJson["id"].isNull())
         {
-            id_=std::make_shared<int32_t>((int32_t)pJson["id"].asInt64());
+            id_.emplace((int32_t)pJson["id"].asInt64());
         }
     }
     if(pJson.isMember("username"))
@@ -183,7 +183,7 @@ void User::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[1] = true;
         if(!pJson["username"].isNull())
         {
-            username_=std::make_shared<std::string>(pJson["username"].asString());
+            username_.emplace(pJson["username"].asString());
         }
     }
     if(pJson.isMember("password"))
@@ -191,7 +191,7 @@ void User::updateByJson(const Json::Value &pJson) noexcept(false)
         dirtyFlag_[2] = true;
         if(!pJson["password"].isNull())
         {
-            password_=std::make_shared<std::string>(pJson["password"].asString());
+            password_.emplace(pJson["password"].asString());
         }
     }
 }
@@ -203,13 +203,13 @@ const int32_t &User::getValueOfId() const noexcept
         return *id_;
     return defaultValue;
 }
-const std::shared_ptr<int32_t> &User::getId() const noexcept
+const int32_t *User::getId() const noexcept
 {
-    return id_;
+    return id_ ? &*id_ : nullptr;
 }
 void User::setId(const int32_t &pId) noexcept
 {
-    id_ = std::make_shared<int32_t>(pId);
+    id_.emplace(pId);
     dirtyFlag_[0] = true;
 }
 const typename User::PrimaryKeyType & User::getPrimaryKey() const
@@ -225,18 +225,18 @@ const std::string &User::getValueOfUsername() const noexcept
         return *username_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &User::getUsername() const noexcept
+const std::string *User::getUsername() const noexcept
 {
-    return username_;
+    return username_ ? &*username_ : nullptr;
 }
 void User::setUsername(const std::string &pUsername) noexcept
 {
-    username_ = std::make_shared<std::string>(pUsername);
+    username_.emplace(pUsername);
     dirtyFlag_[1] = true;
 }
 void User::setUsername(std::string &&pUsername) noexcept
 {
-    username_ = std::make_shared<std::string>(std::move(pUsername));
+    username_.emplace(std::move(pUsername));
     dirtyFlag_[1] = true;
 }
 
@@ -247,18 +247,18 @@ const std::string &User::getValueOfPassword() const noexcept
         return *password_;
     return defaultValue;
 }
-const std::shared_ptr<std::string> &User::getPassword() const noexcept
+const std::string *User::getPassword() const noexcept
 {
-    return password_;
+    return password_ ? &*password_ : nullptr;
 }
 void User::setPassword(const std::string &pPassword) noexcept
 {
-    password_ = std::make_shared<std::string>(pPassword);
+    password_.emplace(pPassword);
     dirtyFlag_[2] = true;
 }
 void User::setPassword(std::string &&pPassword) noexcept
 {
-    password_ = std::make_shared<std::string>(std::move(pPassword));
+    password_.emplace(std::move(pPassword));
     dirtyFlag_[2] = true;
 }
 
@@ -0,0 +1,142 @@
+#include "DbPool.h"
+#include <drogon/drogon.h>
+
+using namespace drogon;
+using namespace drogon::orm;
+
+PoolSizer::PoolSizer(size_t minConnections, size_t maxConnections, double growWait, size_t shrinkAfter)
+  : minConnections{minConnections},
+    maxConnections{std::max(minConnections, maxConnections)},
+    growWait{growWait},
+    shrinkAfter{shrinkAfter} {}
+
+auto PoolSizer::observe(double wait, size_t connections) -> int {
+    average = 0.7 * average + 0.3 * wait;
+    if (average > growWait) {
+        calmSamples = 0;
+        return connections < maxConnections ? 1 : 0;
+    }
+    if (average > growWait / 4) {
+        calmSamples = 0;
+        return 0;
+    }
+    if (++calmSamples < shrinkAfter || connections <= minConnections) {
+        return 0;
+    }
+    calmSamples = 0;
+    return -1;
+}
+
+auto PoolSizer::averageWait() const -> double {
+    return average;
+}
+
+DbPool::DbPool(DbClientPtr base, Settings settings)
+  : settings{std::move(settings)},
+    sizer{this->settings.minConnections, this->settings.maxConnections, this->settings.growWait, this->settings.shrinkAfter} {
+    auto member = std::make_shared<Member>();
+    member->client = std::move(base);
+    member->connections = this->settings.minConnections;
+    members.push_back(std::move(member));
+    connections = this->settings.minConnections;
+}
+
+auto DbPool::client() -> DbClientPtr {
+    std::lock_guard<std::mutex> lock(mutex);
+    // each member takes a share of the queries matching its connections
+    auto slot = next++ % connections;
+    for (const auto &member : members) {
+        if (slot < member->connections) {
+            return member->client;
+        }
+        slot -= member->connections;
+    }
+    return members.front()->client;
+}
+
+void DbPool::sample() {
+    if (settings.connection.empty()) {
+        return;
+    }
+
+    int resize;
+    std::vector<std::shared_ptr<Member>> idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = std::chrono::steady_clock::now();
+        double wait = 0;
+        for (const auto &member : members) {
+            wait += member->probing ? std::chrono::duration<double>(now - member->sentAt).count() : member->wait;
+            if (!member->probing) {
+                idle.push_back(member);
+            }
+        }
+        resize = sizer.observe(wait / members.size(), connections);
+    }
+
+    for (const auto &member : idle) {
+        probe(member);
+    }
+
+    if (resize > 0) {
+        auto member = std::make_shared<Member>();
+        member->client = DbClient::newPgClient(settings.connection, 1);
+        std::lock_guard<std::mutex> lock(mutex);
+        members.push_back(std::move(member));
+        ++connections;
+        ++grown;
+        LOG_DEBUG << "DbPool: grew to " << connections << " connections, waiting " << sizer.averageWait() << "s";
+    } else if (resize < 0) {
+        DbClientPtr retired;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (members.size() == 1) {
+                return;
+            }
+            retired = std::move(members.back()->client);
+            members.pop_back();
+            --connections;
+            ++shrunk;
+            LOG_DEBUG << "DbPool: shrank to " << connections << " connections";
+        }
+        // handlers may still be running queries on it
+        drogon::app().getLoop()->runAfter(settings.retireDelay, [retired]() {});
+    }
+}
+
+void DbPool::probe(const std::shared_ptr<Member> &member) {
+    DbClientPtr client;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (member->probing || !member->client) {
+            return;
+        }
+        member->probing = true;
+        member->sentAt = std::chrono::steady_clock::now();
+        client = member->client;
+    }
+    auto done = [this, member](bool ok) {
+        std::lock_guard<std::mutex> lock(mutex);
+        member->probing = false;
+        member->wait = ok ? std::chrono::duration<double>(std::chrono::steady_clock::now() - member->sentAt).count() : 0;
+    };
+    client->execSqlAsync(
+        "select 1",
+        [done](const Result &) { done(true); },
+        [done](const DrogonDbException &e) {
+            LOG_ERROR << "DbPool: probe failed: " << e.base().what();
+            done(false);
+        });
+}
+
+auto DbPool::stats() const -> Json::Value {
+    std::lock_guard<std::mutex> lock(mutex);
+    Json::Value ret;
+    ret["connections"] = static_cast<Json::UInt64>(connections);
+    ret["min_connections"] = static_cast<Json::UInt64>(settings.minConnections);
+    ret["max_connections"] = static_cast<Json::UInt64>(std::max(settings.minConnections, settings.maxConnections));
+    ret["average_wait_ms"] = sizer.averageWait() * 1000;
+    ret["grown"] = static_cast<Json::UInt64>(grown);
+    ret["shrunk"] = static_cast<Json::UInt64>(shrunk);
+    return ret;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <json/json.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Decides when a DbPool grows or shrinks. Fed the queue wait seen by each
+// sample, it keeps a moving average and asks for one more connection while
+// that average is above growWait, and for one less once it has stayed below a
+// quarter of growWait for shrinkAfter samples in a row.
+class PoolSizer {
+ public:
+    PoolSizer(size_t minConnections, size_t maxConnections, double growWait, size_t shrinkAfter);
+
+    // +1, -1 or 0 connections for a pool currently holding `connections`
+    auto observe(double wait, size_t connections) -> int;
+    // moving average of the observed waits, in seconds
+    auto averageWait() const -> double;
+
+ private:
+    size_t minConnections;
+    size_t maxConnections;
+    double growWait;
+    size_t shrinkAfter;
+    double average{0};
+    size_t calmSamples{0};
+};
+
+// The connections behind one logical database. Drogon's pools are fixed
+// size, so the configured client stays as the floor (min_connections) and
+// the pool adds single-connection clients next to it, up to max_connections,
+// while queries queue up. Queue wait is measured by timing a `select 1` sent
+// to every member each sample: it queues behind whatever the member is
+// already running. Without a connection string the pool is just the
+// configured client.
+class DbPool {
+ public:
+    struct Settings {
+        std::string connection;
+        size_t minConnections{1};
+        size_t maxConnections{1};
+        double growWait{0.02};
+        size_t shrinkAfter{60};
+        // how long a dropped client is kept for the queries still using it
+        double retireDelay{60.0};
+    };
+
+    DbPool(drogon::orm::DbClientPtr base, Settings settings);
+
+    // members in turn, each as often as it has connections
+    auto client() -> drogon::orm::DbClientPtr;
+    // probes every member and resizes the pool on the last probes' results
+    void sample();
+    auto stats() const -> Json::Value;
+
+ private:
+    struct Member {
+        drogon::orm::DbClientPtr client;
+        // only the base client holds more than one
+        size_t connections{1};
+        bool probing{false};
+        std::chrono::steady_clock::time_point sentAt;
+        double wait{0};
+    };
+
+    void probe(const std::shared_ptr<Member> &member);
+
+    Settings settings;
+    // guards everything below
+    mutable std::mutex mutex;
+    // the configured client first, then the ones added on demand
+    std::vector<std::shared_ptr<Member>> members;
+    size_t connections{0};
+    size_t next{0};
+    PoolSizer sizer;
+    uint64_t grown{0};
+    uint64_t shrunk{0};
+};
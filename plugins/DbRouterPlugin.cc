@@ -0,0 +1,149 @@
+#include "DbRouterPlugin.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+
+using namespace drogon;
+using namespace drogon::orm;
+
+namespace {
+// expired windows are swept once the table grows past this
+constexpr size_t recentWritersSweepSize = 4096;
+}
+
+void DbRouterPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "DbRouter initialized and Start";
+    primaryName = config.get("primary", primaryName).asString();
+    primaryPool = makePool(primaryName, config);
+    if (!primaryPool) {
+        LOG_FATAL << "DbRouter: cannot use " << primaryName << " as the primary";
+        return;
+    }
+    for (const auto &name : config["replicas"]) {
+        auto pool = makePool(name.asString(), config);
+        if (!pool) {
+            LOG_ERROR << "DbRouter: ignoring replica " << name.asString();
+            continue;
+        }
+        replicaNames.push_back(name.asString());
+        replicaPools.push_back(std::move(pool));
+    }
+    for (const auto &name : config["fast_replicas"]) {
+        fastReplicaNames.push_back(name.asString());
+    }
+    readYourWrites = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(config.get("read_your_writes", 0.0).asDouble()));
+
+    auto sampleInterval = config.get("sample_interval", 1.0).asDouble();
+    if (sampleInterval > 0) {
+        drogon::app().getLoop()->runEvery(sampleInterval, [this]() {
+            primaryPool->sample();
+            for (auto &pool : replicaPools) {
+                pool->sample();
+            }
+        });
+    }
+}
+
+void DbRouterPlugin::shutdown() {
+    LOG_DEBUG << "DbRouter shut down";
+}
+
+auto DbRouterPlugin::writer(const HttpRequestPtr &req) -> DbClientPtr {
+    if ((!replicaPools.empty() || !fastReplicaNames.empty()) && readYourWrites.count() > 0) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (recentWriters.size() >= recentWritersSweepSize) {
+            for (auto it = recentWriters.begin(); it != recentWriters.end();) {
+                it = it->second <= now ? recentWriters.erase(it) : std::next(it);
+            }
+        }
+        recentWriters[callerOf(req)] = now + readYourWrites;
+    }
+    return primary();
+}
+
+auto DbRouterPlugin::reader(const HttpRequestPtr &req) -> DbClientPtr {
+    return reader(req, false);
+}
+
+auto DbRouterPlugin::reader(const HttpRequestPtr &req, bool cacheable) -> DbClientPtr {
+    auto replicated = !replicaPools.empty() || !fastReplicaNames.empty();
+    if (readsPrimary(replicated, cacheable, replicated && isRecentWriter(req))) {
+        return primary();
+    }
+    if (!fastReplicaNames.empty()) {
+        // the calling IO loop's own connection
+        return drogon::app().getFastDbClient(fastReplicaNames[nextReplica++ % fastReplicaNames.size()]);
+    }
+    return replicaPools[nextReplica++ % replicaPools.size()]->client();
+}
+
+auto DbRouterPlugin::readsPrimary(bool replicated, bool cacheable, bool recentWriter) -> bool {
+    return !replicated || cacheable || recentWriter;
+}
+
+auto DbRouterPlugin::isRecentWriter(const HttpRequestPtr &req) -> bool {
+    if (readYourWrites.count() == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = recentWriters.find(callerOf(req));
+    if (it == recentWriters.end()) {
+        return false;
+    }
+    if (it->second > std::chrono::steady_clock::now()) {
+        return true;
+    }
+    recentWriters.erase(it);
+    return false;
+}
+
+auto DbRouterPlugin::primary() const -> DbClientPtr {
+    // not configured as a plugin: plain drogon client
+    if (!primaryPool) {
+        return drogon::app().getDbClient(primaryName);
+    }
+    return primaryPool->client();
+}
+
+auto DbRouterPlugin::stats() const -> Json::Value {
+    Json::Value ret;
+    if (primaryPool) {
+        ret[primaryName] = primaryPool->stats();
+    }
+    for (size_t i = 0; i < replicaPools.size(); ++i) {
+        ret[replicaNames[i]] = replicaPools[i]->stats();
+    }
+    return ret;
+}
+
+auto DbRouterPlugin::makePool(const std::string &name, const Json::Value &config) -> std::unique_ptr<DbPool> {
+    auto base = drogon::app().getDbClient(name);
+    if (!base) {
+        LOG_FATAL << "DbRouter: no db client named " << name;
+        return nullptr;
+    }
+    const auto &pool = config["pools"][name];
+    // the configured client is the floor of its pool
+    auto baseConnections = config["client_connections"].get(name, 0).asUInt();
+    if (baseConnections == 0) {
+        baseConnections = std::max(1u, pool.get("min_connections", 1).asUInt());
+        LOG_WARN << "DbRouter: number_of_connections of " << name << " unknown, assuming " << baseConnections;
+    } else if (pool.isMember("min_connections") && pool["min_connections"].asUInt() != baseConnections) {
+        LOG_FATAL << "DbRouter: pool " << name << " has min_connections " << pool["min_connections"].asUInt()
+                  << " but the client opens " << baseConnections;
+        return nullptr;
+    }
+    DbPool::Settings settings;
+    settings.connection = pool.get("connection", "").asString();
+    settings.minConnections = baseConnections;
+    settings.maxConnections = pool.get("max_connections", static_cast<Json::UInt>(settings.minConnections)).asUInt();
+    settings.growWait = pool.get("grow_wait", settings.growWait).asDouble();
+    settings.shrinkAfter = pool.get("shrink_after", static_cast<Json::UInt>(settings.shrinkAfter)).asUInt();
+    return std::make_unique<DbPool>(std::move(base), std::move(settings));
+}
+
+auto DbRouterPlugin::callerOf(const HttpRequestPtr &req) -> std::string {
+    const auto &authorization = req->getHeader("authorization");
+    return authorization.empty() ? req->getPeerAddr().toIp() : authorization;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <drogon/HttpRequest.h>
+#include <drogon/orm/DbClient.h>
+#include "DbPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Picks the database client for a query: writes go to the primary, reads
+// round-robin over the replicas. A caller (bearer token, else peer address)
+// that has just written keeps reading from the primary for read_your_writes
+// seconds, long enough for the replicas to catch up with its change. With no
+// replicas configured everything goes to the primary, which defaults to
+// drogon's "default" client. Each of them can be given a pool entry, making
+// it a DbPool that grows and shrinks with its queue. drogon does not expose
+// a client's connection count, so main() copies each one's
+// number_of_connections into client_connections.
+//
+// Reads can instead go to fast_replicas, drogon clients configured with
+// is_fast: those keep connections per IO loop, so a read is sent and
+// answered on the loop that took the request instead of being handed to a
+// shared pool's threads and back.
+class DbRouterPlugin : public drogon::Plugin<DbRouterPlugin> {
+ public:
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    // for inserts, updates and deletes made on behalf of req
+    auto writer(const drogon::HttpRequestPtr &req) -> drogon::orm::DbClientPtr;
+    // for reads made on behalf of req; must be called on an IO loop when
+    // fast_replicas are configured
+    auto reader(const drogon::HttpRequestPtr &req) -> drogon::orm::DbClientPtr;
+    // as above, for a read whose answer gets cached or tagged if cacheable
+    auto reader(const drogon::HttpRequestPtr &req, bool cacheable) -> drogon::orm::DbClientPtr;
+    // Whether a read goes to the primary. Cacheable ones always do: they
+    // must hold every write their table versions count, which a replica may
+    // not have yet. That costs a primary query per key and invalidation.
+    static auto readsPrimary(bool replicated, bool cacheable, bool recentWriter) -> bool;
+    // for internal work that must see every committed write
+    auto primary() const -> drogon::orm::DbClientPtr;
+    // sizes and queue waits of the pools, by client name
+    auto stats() const -> Json::Value;
+
+ private:
+    static auto callerOf(const drogon::HttpRequestPtr &req) -> std::string;
+    // whether req's caller is inside its read-your-writes window
+    auto isRecentWriter(const drogon::HttpRequestPtr &req) -> bool;
+
+    // nullptr, having said why, if name is unknown or its pool entry
+    // disagrees with the client's number_of_connections
+    static auto makePool(const std::string &name, const Json::Value &config) -> std::unique_ptr<DbPool>;
+
+    std::string primaryName{"default"};
+    std::unique_ptr<DbPool> primaryPool;
+    std::vector<std::string> replicaNames;
+    std::vector<std::unique_ptr<DbPool>> replicaPools;
+    std::vector<std::string> fastReplicaNames;
+    std::atomic<size_t> nextReplica{0};
+    std::chrono::steady_clock::duration readYourWrites{};
+    // guards recentWriters
+    std::mutex mutex;
+    // when each caller's read-your-writes window closes
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> recentWriters;
+};
@@ -0,0 +1,161 @@
+#include "HeadcountIndex.h"
+#include <trantor/utils/Logger.h>
+#include <iterator>
+#include <limits>
+
+namespace {
+constexpr int32_t noManager = std::numeric_limits<int32_t>::min();
+}
+
+HeadcountIndex::HeadcountIndex(std::shared_ptr<const OrgGraph> graph)
+  : graph{std::move(graph)}, fenwick(this->graph->size() + 1, 0) {}
+
+void HeadcountIndex::upsert(int32_t personId, int32_t managerId) {
+    if (managerId == personId) {
+        managerId = noManager;
+    }
+
+    auto index = graph->indexOf(personId);
+    auto isNew = pending.find(personId) == pending.end() && (index == OrgGraph::npos || erased.count(index) > 0);
+    if (isNew) {
+        pending[personId] = Pending{managerId, 0};
+        addToChain(managerId, 1);
+        return;
+    }
+
+    auto oldManagerId = managerOf(personId);
+    if (oldManagerId == managerId) {
+        return;
+    }
+    // the whole team moves along with its manager
+    auto moving = headcount(personId) + 1;
+    addToChain(oldManagerId, -moving);
+    auto p = pending.find(personId);
+    if (p != pending.end()) {
+        p->second.managerId = managerId;
+    } else {
+        moved[graph->preorder(index)] = Moved{index, managerId};
+    }
+    addToChain(managerId, moving);
+}
+
+void HeadcountIndex::erase(int32_t personId) {
+    auto p = pending.find(personId);
+    if (p != pending.end()) {
+        auto managerId = p->second.managerId;
+        auto leaving = p->second.headcount + 1;
+        pending.erase(p);
+        addToChain(managerId, -leaving);
+        return;
+    }
+
+    auto index = graph->indexOf(personId);
+    if (index == OrgGraph::npos || erased.count(index) > 0) {
+        return;
+    }
+    addToChain(managerOf(personId), -(headcount(personId) + 1));
+    erased.insert(index);
+    moved.erase(graph->preorder(index));
+}
+
+auto HeadcountIndex::headcount(int32_t personId) const -> int64_t {
+    auto p = pending.find(personId);
+    if (p != pending.end()) {
+        return p->second.headcount;
+    }
+    auto index = graph->indexOf(personId);
+    if (index == OrgGraph::npos || erased.count(index) > 0) {
+        return -1;
+    }
+    return graph->headcount(index) + sumOver(graph->preorder(index), graph->subtreeEnd(index));
+}
+
+auto HeadcountIndex::managerOf(int32_t personId) const -> int32_t {
+    auto p = pending.find(personId);
+    if (p != pending.end()) {
+        return p->second.managerId;
+    }
+    auto index = graph->indexOf(personId);
+    if (index == OrgGraph::npos || erased.count(index) > 0) {
+        return noManager;
+    }
+    auto m = moved.find(graph->preorder(index));
+    if (m != moved.end()) {
+        return m->second.managerId;
+    }
+    auto manager = graph->manager(index);
+    return manager == OrgGraph::npos ? noManager : graph->person(manager).getValueOfId();
+}
+
+void HeadcountIndex::addToChain(int32_t personId, int64_t delta) {
+    // every hop past the first follows a pending or moved link, so their
+    // count bounds the walk even if the edits formed a management cycle
+    auto hops = pending.size() + moved.size() + 1;
+    while (hops-- > 0) {
+        auto p = pending.find(personId);
+        if (p != pending.end()) {
+            p->second.headcount += delta;
+            personId = p->second.managerId;
+            continue;
+        }
+
+        auto index = graph->indexOf(personId);
+        if (index == OrgGraph::npos || erased.count(index) > 0) {
+            return;
+        }
+        addAt(index, delta);
+
+        // The snapshot still files index under its old managers. If it sits in
+        // a team that has moved since, take the delta back from the team's old
+        // manager upwards and continue from its new manager instead; the
+        // innermost such team decides.
+        auto team = movedTeamOf(index);
+        if (team == OrgGraph::npos) {
+            return;
+        }
+        auto oldManager = graph->manager(team);
+        if (oldManager != OrgGraph::npos) {
+            addAt(oldManager, -delta);
+        }
+        personId = moved.at(graph->preorder(team)).managerId;
+    }
+    LOG_WARN << "HeadcountIndex: management cycle through person " << personId;
+}
+
+auto HeadcountIndex::movedTeamOf(OrgGraph::Index index) const -> OrgGraph::Index {
+    // The team starting last at or before `at` either contains index, and is
+    // then the innermost one that does, or lies wholly before `at`'s subtree.
+    // In that case every team containing index contains it too, so the search
+    // goes on from their common manager, strictly above `at`.
+    const auto position = graph->preorder(index);
+    auto at = index;
+    while (at != OrgGraph::npos) {
+        auto it = moved.upper_bound(graph->preorder(at));
+        if (it == moved.begin()) {
+            return OrgGraph::npos;
+        }
+        auto team = std::prev(it)->second.index;
+        if (graph->subtreeEnd(team) >= position) {
+            return team;
+        }
+        at = graph->commonManager(team, index);
+    }
+    return OrgGraph::npos;
+}
+
+void HeadcountIndex::addAt(OrgGraph::Index index, int64_t delta) {
+    for (auto i = graph->preorder(index) + 1; i < fenwick.size(); i += i & (~i + 1)) {
+        fenwick[i] += delta;
+    }
+}
+
+auto HeadcountIndex::sumOver(uint32_t first, uint32_t last) const -> int64_t {
+    auto prefix = [this](uint32_t end) {
+        int64_t sum = 0;
+        for (auto i = end; i > 0; i -= i & (~i + 1)) {
+            sum += fenwick[i];
+        }
+        return sum;
+    };
+    return prefix(last + 1) - prefix(first);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "OrgGraph.h"
+
+// Transitive headcount per manager on top of an OrgGraph snapshot, kept
+// current across writes made after the snapshot was taken.
+//
+// The snapshot already knows every subtree size (its preorder intervals).
+// Later changes are recorded as deltas in a Fenwick tree over the same
+// preorder positions: adding d at a person's position adds d to that person
+// and to everyone above them, since their intervals contain it. Creates,
+// deletes and manager changes cost O(log n) per moved team they pass through
+// on the way up, plus a lookup per level at which moved teams beside that
+// path have to be stepped over.
+// Persons created after the snapshot and persons moved to another manager
+// are tracked on the side until the next snapshot absorbs them.
+class HeadcountIndex {
+ public:
+    explicit HeadcountIndex(std::shared_ptr<const OrgGraph> graph);
+
+    // records a new person or a manager change
+    void upsert(int32_t personId, int32_t managerId);
+    void erase(int32_t personId);
+    // number of persons below personId, -1 if unknown
+    auto headcount(int32_t personId) const -> int64_t;
+
+ private:
+    struct Pending {
+        int32_t managerId;
+        int64_t headcount;
+    };
+    struct Moved {
+        OrgGraph::Index index;
+        int32_t managerId;
+    };
+
+    auto managerOf(int32_t personId) const -> int32_t;
+    // adds delta to personId and everyone above them
+    void addToChain(int32_t personId, int64_t delta);
+    // innermost moved team (snapshot subtree) containing index, npos if none
+    auto movedTeamOf(OrgGraph::Index index) const -> OrgGraph::Index;
+    void addAt(OrgGraph::Index index, int64_t delta);
+    auto sumOver(uint32_t first, uint32_t last) const -> int64_t;
+
+    std::shared_ptr<const OrgGraph> graph;
+    std::vector<int64_t> fenwick;
+    // snapshot persons now reporting to someone else, by preorder position;
+    // their subtrees nest or are disjoint, as preorder intervals do
+    std::map<uint32_t, Moved> moved;
+    std::unordered_set<OrgGraph::Index> erased;
+    // persons created after the snapshot
+    std::unordered_map<int32_t, Pending> pending;
+};
@@ -0,0 +1,277 @@
+#include "OrgGraph.h"
+#include <algorithm>
+
+using namespace drogon_model::org_chart;
+
+OrgGraph::OrgGraph(std::vector<Person> persons) : people{std::move(persons)} {
+    std::sort(people.begin(), people.end(), [](const Person &a, const Person &b) {
+        return a.getValueOfId() < b.getValueOfId();
+    });
+
+    const auto n = static_cast<Index>(people.size());
+    ids.reserve(n);
+    for (const auto &p : people) {
+        ids.push_back(p.getValueOfId());
+    }
+
+    managers.assign(n, npos);
+    reportOffsets.assign(n + 1, 0);
+    for (Index i = 0; i < n; ++i) {
+        if (!people[i].getManagerId()) {
+            continue;
+        }
+        auto m = indexOf(people[i].getValueOfManagerId());
+        if (m != i) {
+            managers[i] = m;
+        }
+    }
+    breakCycles();
+    for (Index i = 0; i < n; ++i) {
+        if (managers[i] != npos) {
+            ++reportOffsets[managers[i] + 1];
+        }
+    }
+
+    // counting sort into CSR; reports of each manager stay in id order
+    for (Index i = 0; i < n; ++i) {
+        reportOffsets[i + 1] += reportOffsets[i];
+    }
+    reports.resize(reportOffsets[n]);
+    std::vector<Index> cursor(reportOffsets.begin(), reportOffsets.end() - 1);
+    for (Index i = 0; i < n; ++i) {
+        if (managers[i] != npos) {
+            reports[cursor[managers[i]]++] = i;
+        }
+    }
+
+    buildAncestors();
+    buildEulerTour();
+}
+
+// walks each management chain once; a chain that runs back into itself is
+// cut by promoting the person where it closes to a root
+void OrgGraph::breakCycles() {
+    enum : uint8_t { unvisited, onPath, done };
+    std::vector<uint8_t> state(managers.size(), unvisited);
+    std::vector<Index> path;
+    for (Index start = 0; start < managers.size(); ++start) {
+        auto i = start;
+        while (i != npos && state[i] == unvisited) {
+            state[i] = onPath;
+            path.push_back(i);
+            i = managers[i];
+        }
+        if (i != npos && state[i] == onPath) {
+            LOG_WARN << "OrgGraph: management cycle through person " << ids[i];
+            managers[i] = npos;
+        }
+        for (auto p : path) {
+            state[p] = done;
+        }
+        path.clear();
+    }
+}
+
+void OrgGraph::buildAncestors() {
+    const auto n = static_cast<Index>(managers.size());
+    // roots first, then breadth-first, so every manager precedes its reports
+    std::vector<Index> order;
+    order.reserve(n);
+    for (Index i = 0; i < n; ++i) {
+        if (managers[i] == npos) {
+            order.push_back(i);
+        }
+    }
+    depths.assign(n, 0);
+    treeRoots.assign(n, npos);
+    uint32_t maxDepth = 0;
+    for (size_t head = 0; head < order.size(); ++head) {
+        auto i = order[head];
+        if (treeRoots[i] == npos) {
+            treeRoots[i] = i;
+        }
+        auto range = directReports(i);
+        for (auto it = range.first; it != range.second; ++it) {
+            depths[*it] = depths[i] + 1;
+            treeRoots[*it] = treeRoots[i];
+            maxDepth = std::max(maxDepth, depths[*it]);
+            order.push_back(*it);
+        }
+    }
+
+    size_t levels = 1;
+    while ((1u << levels) <= maxDepth) {
+        ++levels;
+    }
+    jumps.resize(levels * n);
+    std::copy(managers.begin(), managers.end(), jumps.begin());
+    for (size_t k = 1; k < levels; ++k) {
+        const auto *prev = jumps.data() + (k - 1) * n;
+        auto *cur = jumps.data() + k * n;
+        for (Index i = 0; i < n; ++i) {
+            cur[i] = prev[i] == npos ? npos : prev[prev[i]];
+        }
+    }
+}
+
+void OrgGraph::buildEulerTour() {
+    const auto n = static_cast<Index>(managers.size());
+    std::vector<Index> tour;
+    tour.reserve(2 * n);
+    firstVisits.assign(n, 0);
+    entries.assign(n, 0);
+    exits.assign(n, 0);
+    uint32_t clock = 0;
+
+    // iterative DFS; each stack entry remembers the next report to descend into
+    std::vector<std::pair<Index, const Index *>> stack;
+    for (Index root = 0; root < n; ++root) {
+        if (managers[root] != npos) {
+            continue;
+        }
+        firstVisits[root] = static_cast<uint32_t>(tour.size());
+        entries[root] = clock++;
+        tour.push_back(root);
+        stack.emplace_back(root, directReports(root).first);
+        while (!stack.empty()) {
+            auto &top = stack.back();
+            if (top.second == directReports(top.first).second) {
+                exits[top.first] = clock - 1;
+                stack.pop_back();
+                if (!stack.empty()) {
+                    tour.push_back(stack.back().first);
+                }
+                continue;
+            }
+            auto next = *top.second++;
+            firstVisits[next] = static_cast<uint32_t>(tour.size());
+            entries[next] = clock++;
+            tour.push_back(next);
+            stack.emplace_back(next, directReports(next).first);
+        }
+    }
+
+    minDepth.clear();
+    minDepth.push_back(std::move(tour));
+    for (size_t k = 1; (size_t{1} << k) <= minDepth[0].size(); ++k) {
+        const auto &prev = minDepth[k - 1];
+        const auto half = size_t{1} << (k - 1);
+        std::vector<Index> cur(prev.size() - half);
+        for (size_t p = 0; p < cur.size(); ++p) {
+            auto l = prev[p];
+            auto r = prev[p + half];
+            cur[p] = depths[l] <= depths[r] ? l : r;
+        }
+        minDepth.push_back(std::move(cur));
+    }
+
+    spanLevels.assign(minDepth[0].size() + 1, 0);
+    for (size_t len = 2; len < spanLevels.size(); ++len) {
+        spanLevels[len] = spanLevels[len / 2] + 1;
+    }
+}
+
+auto OrgGraph::size() const -> size_t {
+    return people.size();
+}
+
+auto OrgGraph::indexOf(int32_t personId) const -> Index {
+    auto it = std::lower_bound(ids.begin(), ids.end(), personId);
+    if (it == ids.end() || *it != personId) {
+        return npos;
+    }
+    return static_cast<Index>(it - ids.begin());
+}
+
+auto OrgGraph::person(Index index) const -> const Person & {
+    return people[index];
+}
+
+auto OrgGraph::persons() const -> const std::vector<Person> & {
+    return people;
+}
+
+auto OrgGraph::manager(Index index) const -> Index {
+    return managers[index];
+}
+
+auto OrgGraph::directReports(Index index) const -> IndexRange {
+    const auto *base = reports.data();
+    return {base + reportOffsets[index], base + reportOffsets[index + 1]};
+}
+
+auto OrgGraph::subtree(Index root, int maxDepth) const -> std::vector<std::pair<Index, int>> {
+    std::vector<std::pair<Index, int>> ret{{root, 0}};
+    for (size_t head = 0; head < ret.size(); ++head) {
+        auto depth = ret[head].second;
+        if (depth >= maxDepth) {
+            continue;
+        }
+        auto range = directReports(ret[head].first);
+        for (auto it = range.first; it != range.second; ++it) {
+            ret.emplace_back(*it, depth + 1);
+        }
+    }
+    return ret;
+}
+
+auto OrgGraph::depth(Index index) const -> uint32_t {
+    return depths[index];
+}
+
+auto OrgGraph::ancestor(Index index, uint32_t levels) const -> Index {
+    if (levels > depths[index]) {
+        return npos;
+    }
+    const auto n = managers.size();
+    for (size_t k = 0; levels != 0; ++k, levels >>= 1) {
+        if (levels & 1u) {
+            index = jumps[k * n + index];
+        }
+    }
+    return index;
+}
+
+auto OrgGraph::chain(Index index, uint32_t maxLevels) const -> std::vector<Index> {
+    auto levels = std::min(depths[index], maxLevels);
+    std::vector<Index> ret;
+    ret.reserve(levels + 1);
+    ret.push_back(index);
+    // every intermediate manager is returned, so jumping ahead buys nothing
+    for (uint32_t l = 0; l < levels; ++l) {
+        index = managers[index];
+        ret.push_back(index);
+    }
+    return ret;
+}
+
+auto OrgGraph::commonManager(Index a, Index b) const -> Index {
+    if (treeRoots[a] != treeRoots[b]) {
+        return npos;
+    }
+    auto l = firstVisits[a];
+    auto r = firstVisits[b];
+    if (l > r) {
+        std::swap(l, r);
+    }
+    auto k = spanLevels[r - l + 1];
+    auto x = minDepth[k][l];
+    auto y = minDepth[k][r + 1 - (size_t{1} << k)];
+    return depths[x] <= depths[y] ? x : y;
+}
+
+auto OrgGraph::isUnder(Index index, Index manager) const -> bool {
+    return entries[manager] < entries[index] && entries[index] <= exits[manager];
+}
+
+auto OrgGraph::preorder(Index index) const -> uint32_t {
+    return entries[index];
+}
+
+auto OrgGraph::subtreeEnd(Index index) const -> uint32_t {
+    return exits[index];
+}
+
+auto OrgGraph::headcount(Index index) const -> uint32_t {
+    return exits[index] - entries[index];
+}
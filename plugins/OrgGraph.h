@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "../models/Person.h"
+
+// Immutable in-memory snapshot of the person table, laid out as a
+// manager -> reports graph. Persons are addressed by a dense index (their
+// position in id order); the reports of index i live contiguously in
+// reports[reportOffsets[i] .. reportOffsets[i + 1]). Manager cycles are
+// broken on construction, so the graph is always a forest.
+class OrgGraph {
+ public:
+    using Index = uint32_t;
+    using IndexRange = std::pair<const Index *, const Index *>;
+    static constexpr Index npos = UINT32_MAX;
+
+    explicit OrgGraph(std::vector<drogon_model::org_chart::Person> persons);
+
+    auto size() const -> size_t;
+    auto indexOf(int32_t personId) const -> Index;
+    auto person(Index index) const -> const drogon_model::org_chart::Person &;
+    auto persons() const -> const std::vector<drogon_model::org_chart::Person> &;
+    // npos for roots, i.e. persons managing themselves or whose manager is unknown
+    auto manager(Index index) const -> Index;
+    auto directReports(Index index) const -> IndexRange;
+    // breadth-first (index, depth) pairs below root, root itself at depth 0
+    auto subtree(Index root, int maxDepth) const -> std::vector<std::pair<Index, int>>;
+    // number of managers above index
+    auto depth(Index index) const -> uint32_t;
+    // the manager `levels` steps up, npos past the root; O(log depth)
+    auto ancestor(Index index, uint32_t levels) const -> Index;
+    // index followed by up to maxLevels of its managers, nearest first; one
+    // O(1) step per returned manager, so linear in the output like any listing
+    // has to be (ancestor() is for when only the endpoint is wanted)
+    auto chain(Index index, uint32_t maxLevels) const -> std::vector<Index>;
+    // lowest person managing both a and b (either of them counts), npos if
+    // they sit in different trees; O(1)
+    auto commonManager(Index a, Index b) const -> Index;
+    // whether manager manages index directly or transitively; O(1)
+    auto isUnder(Index index, Index manager) const -> bool;
+    // preorder position of index; its subtree spans [preorder, subtreeEnd]
+    auto preorder(Index index) const -> uint32_t;
+    auto subtreeEnd(Index index) const -> uint32_t;
+    // number of persons below index
+    auto headcount(Index index) const -> uint32_t;
+
+ private:
+    void breakCycles();
+    void buildAncestors();
+    void buildEulerTour();
+
+    std::vector<drogon_model::org_chart::Person> people;
+    std::vector<int32_t> ids;
+    std::vector<Index> managers;
+    std::vector<Index> reportOffsets;
+    std::vector<Index> reports;
+    std::vector<uint32_t> depths;
+    // binary lifting table, jumps[k * size() + i] is the 2^k-th manager of i
+    std::vector<Index> jumps;
+    std::vector<Index> treeRoots;
+    // first position of each person in the Euler tour of the forest, and a
+    // sparse table over the tour: minDepth[k][p] is the shallowest person in
+    // tour positions [p, p + 2^k)
+    std::vector<uint32_t> firstVisits;
+    // preorder number of each person and the last preorder number in their
+    // subtree, so the subtree of i is exactly the interval [entries[i], exits[i]]
+    std::vector<uint32_t> entries;
+    std::vector<uint32_t> exits;
+    std::vector<std::vector<Index>> minDepth;
+    // floor(log2(len)), picks the sparse table row covering a span of len
+    std::vector<uint8_t> spanLevels;
+};
@@ -0,0 +1,197 @@
+#include "OrgGraphPlugin.h"
+#include "DbRouterPlugin.h"
+#include "ResultCachePlugin.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <iterator>
+
+using namespace drogon;
+using namespace drogon::orm;
+using namespace drogon_model::org_chart;
+
+void OrgGraphPlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "OrgGraph initialized and Start";
+    this->config = config;
+    rebuildDelay = config.get("rebuild_delay", 1.0).asDouble();
+    reload();
+
+    auto refreshInterval = config.get("refresh_interval", 0).asDouble();
+    if (refreshInterval > 0) {
+        drogon::app().getLoop()->runEvery(refreshInterval, [this]() { reload(); });
+    }
+}
+
+void OrgGraphPlugin::shutdown() {
+    LOG_DEBUG << "OrgGraph shut down";
+}
+
+auto OrgGraphPlugin::snapshot() const -> std::shared_ptr<const OrgGraph> {
+    std::lock_guard<std::mutex> lock(mutex);
+    return graph;
+}
+
+auto OrgGraphPlugin::isUnder(int32_t personId, int32_t managerId) const -> bool {
+    auto current = snapshot();
+    if (!current) {
+        return false;
+    }
+    auto index = current->indexOf(personId);
+    auto manager = current->indexOf(managerId);
+    return index != OrgGraph::npos && manager != OrgGraph::npos && current->isUnder(index, manager);
+}
+
+auto OrgGraphPlugin::headcount(int32_t personId) const -> int64_t {
+    std::lock_guard<std::mutex> lock(mutex);
+    return headcounts ? headcounts->headcount(personId) : -1;
+}
+
+void OrgGraphPlugin::reload() {
+    uint64_t startedAt;
+    {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        startedAt = generation;
+        loading.insert(startedAt);
+    }
+
+    Mapper<Person> mp(drogon::app().getPlugin<DbRouterPlugin>()->primary());
+    mp.findAll(
+        [this, startedAt](std::vector<Person> persons) {
+            LOG_DEBUG << "OrgGraph loaded " << persons.size() << " persons";
+            // local writes that landed during the load may or may not be in
+            // the result; laying them over it again is harmless
+            std::lock_guard<std::mutex> buildLock(buildMutex);
+            publish(std::move(persons), startedAt, true);
+        },
+        [this, startedAt](const DrogonDbException &e) {
+            LOG_ERROR << "OrgGraph load failed: " << e.base().what();
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+            loading.erase(loading.find(startedAt));
+        });
+}
+
+void OrgGraphPlugin::upsert(const Person &person) {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    edits[person.getValueOfId()] = Edit{std::make_shared<Person>(person), ++generation};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!graph) {
+            // the first load picks it up
+            return;
+        }
+        headcounts->upsert(person.getValueOfId(), person.getValueOfManagerId());
+    }
+    scheduleRebuild();
+}
+
+void OrgGraphPlugin::erase(int32_t personId) {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    edits[personId] = Edit{nullptr, ++generation};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!graph) {
+            return;
+        }
+        headcounts->erase(personId);
+    }
+    scheduleRebuild();
+}
+
+// callers hold writeMutex
+void OrgGraphPlugin::scheduleRebuild() {
+    if (rebuildScheduled) {
+        return;
+    }
+    rebuildScheduled = true;
+    drogon::app().getLoop()->runAfter(rebuildDelay, [this]() { rebuild(); });
+}
+
+void OrgGraphPlugin::rebuild() {
+    std::lock_guard<std::mutex> buildLock(buildMutex);
+    uint64_t base;
+    {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        rebuildScheduled = false;
+        if (generation == graphGeneration) {
+            return;
+        }
+        base = graphGeneration;
+    }
+    // graph and graphGeneration only change under buildMutex
+    auto current = snapshot();
+    if (current) {
+        publish(current->persons(), base, false);
+    }
+}
+
+void OrgGraphPlugin::publish(std::vector<Person> persons, uint64_t base, bool load) {
+    uint64_t folded;
+    Changes changes;
+    {
+        std::lock_guard<std::mutex> writeLock(writeMutex);
+        changes = editsAfter(base);
+        folded = generation;
+    }
+    // the expensive part, while writes go on against the current graph
+    fold(persons, changes);
+    auto next = std::make_shared<const OrgGraph>(std::move(persons));
+    auto nextHeadcounts = std::make_unique<HeadcountIndex>(next);
+
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    // writes made while building only reached the old counts
+    for (const auto &edit : editsAfter(folded)) {
+        if (edit.second) {
+            nextHeadcounts->upsert(edit.first, edit.second->getValueOfManagerId());
+        } else {
+            nextHeadcounts->erase(edit.first);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        graph = std::move(next);
+        headcounts = std::move(nextHeadcounts);
+    }
+    // person answers carry headcounts, so their ETags have to change with
+    // them; a load can bring in writes other instances made long ago
+    drogon::app().getPlugin<ResultCachePlugin>()->invalidate("person");
+    graphGeneration = folded;
+    if (load) {
+        loading.erase(loading.find(base));
+    }
+    forgetEdits(folded);
+    if (generation != graphGeneration) {
+        scheduleRebuild();
+    }
+}
+
+auto OrgGraphPlugin::editsAfter(uint64_t after) const -> Changes {
+    Changes ret;
+    for (const auto &edit : edits) {
+        if (edit.second.generation > after) {
+            ret.emplace(edit.first, edit.second.person);
+        }
+    }
+    return ret;
+}
+
+void OrgGraphPlugin::fold(std::vector<Person> &persons, const Changes &changes) {
+    if (changes.empty()) {
+        return;
+    }
+    persons.erase(std::remove_if(persons.begin(), persons.end(),
+                                 [&changes](const Person &p) { return changes.count(p.getValueOfId()) > 0; }),
+                  persons.end());
+    for (const auto &change : changes) {
+        if (change.second) {
+            persons.push_back(*change.second);
+        }
+    }
+}
+
+void OrgGraphPlugin::forgetEdits(uint64_t upTo) {
+    if (!loading.empty()) {
+        upTo = std::min(upTo, *loading.begin());
+    }
+    for (auto it = edits.begin(); it != edits.end();) {
+        it = it->second.generation <= upTo ? edits.erase(it) : std::next(it);
+    }
+}
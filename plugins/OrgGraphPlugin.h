@@ -0,0 +1,78 @@
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "OrgGraph.h"
+#include "HeadcountIndex.h"
+
+// Keeps an OrgGraph snapshot of the person table so hierarchy reads can be
+// answered without a database round trip. Local writes reach the headcounts
+// immediately and the snapshot itself through a rebuild that runs at most
+// once per rebuild_delay; readers hold on to whatever snapshot they picked up.
+// Publishing a snapshot bumps the person table's ResultCache version, since
+// person answers include headcounts.
+class OrgGraphPlugin : public drogon::Plugin<OrgGraphPlugin> {
+ public:
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    // nullptr until the first load has completed
+    auto snapshot() const -> std::shared_ptr<const OrgGraph>;
+    // Whether managerId manages personId directly or transitively. Meant for
+    // authorization checks, so it answers false for unknown persons and while
+    // the graph is not loaded yet.
+    auto isUnder(int32_t personId, int32_t managerId) const -> bool;
+    // number of persons below personId, -1 if unknown or not loaded yet
+    auto headcount(int32_t personId) const -> int64_t;
+    void reload();
+    void upsert(const drogon_model::org_chart::Person &person);
+    void erase(int32_t personId);
+
+ private:
+    struct Edit {
+        // nullptr for deletes
+        std::shared_ptr<drogon_model::org_chart::Person> person;
+        uint64_t generation;
+    };
+
+    using Changes = std::map<int32_t, std::shared_ptr<drogon_model::org_chart::Person>>;
+
+    void scheduleRebuild();
+    void rebuild();
+    // Callers hold buildMutex. Publishes persons, which have every local
+    // write up to base, with the later ones laid over them; load tells that
+    // they come from the load sent at base.
+    void publish(std::vector<drogon_model::org_chart::Person> persons, uint64_t base, bool load);
+    // callers hold writeMutex: the latest edit of every person edited after `after`
+    auto editsAfter(uint64_t after) const -> Changes;
+    static void fold(std::vector<drogon_model::org_chart::Person> &persons, const Changes &changes);
+    // callers hold writeMutex: drops edits up to upTo no running load needs
+    void forgetEdits(uint64_t upTo);
+
+    Json::Value config;
+    double rebuildDelay{1.0};
+    // one build at a time, so an older base never replaces a newer graph;
+    // held while building, which writes must not wait for
+    std::mutex buildMutex;
+    // serialises writes against publishing, guards everything but the
+    // published state
+    std::mutex writeMutex;
+    // guards the published state below
+    mutable std::mutex mutex;
+    std::shared_ptr<const OrgGraph> graph;
+    std::unique_ptr<HeadcountIndex> headcounts;
+    // numbers local writes
+    uint64_t generation{0};
+    // newest local write the published graph has
+    uint64_t graphGeneration{0};
+    // generation at which each load in flight was sent
+    std::multiset<uint64_t> loading;
+    // local writes, latest per person, kept until neither the graph nor a
+    // load in flight can be missing them
+    std::map<int32_t, Edit> edits;
+    bool rebuildScheduled{false};
+};
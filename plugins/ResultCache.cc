@@ -0,0 +1,69 @@
+#include "ResultCache.h"
+#include <algorithm>
+
+ResultCache::ResultCache(size_t maxEntries) : maxEntries{maxEntries} {}
+
+auto ResultCache::find(const std::string &table, const std::string &key, Entry &entry) -> bool {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto t = tables.find(table);
+    if (t != tables.end()) {
+        auto e = t->second.entries.find(key);
+        if (e != t->second.entries.end()) {
+            entry = e->second;
+            ++hits;
+            return true;
+        }
+    }
+    ++misses;
+    return false;
+}
+
+auto ResultCache::version(const std::string &table) const -> uint64_t {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto t = tables.find(table);
+    return t == tables.end() ? baseline : versionOf(t->second);
+}
+
+void ResultCache::store(const std::string &table, const std::string &key, uint64_t version, Entry entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &t = tables[table];
+    if (versionOf(t) != version || t.entries.size() >= maxEntries) {
+        return;
+    }
+    t.entries[key] = std::move(entry);
+}
+
+void ResultCache::invalidate(const std::string &table) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &t = tables[table];
+    t.version = ++clock;
+    t.entries.clear();
+    ++invalidations;
+}
+
+void ResultCache::invalidateAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    baseline = ++clock;
+    for (auto &t : tables) {
+        t.second.entries.clear();
+    }
+    ++invalidations;
+}
+
+auto ResultCache::versionOf(const Table &table) const -> uint64_t {
+    return std::max(table.version, baseline);
+}
+
+auto ResultCache::stats() const -> Json::Value {
+    std::lock_guard<std::mutex> lock(mutex);
+    Json::Value ret;
+    ret["hits"] = static_cast<Json::UInt64>(hits);
+    ret["misses"] = static_cast<Json::UInt64>(misses);
+    ret["invalidations"] = static_cast<Json::UInt64>(invalidations);
+    Json::Value entries(Json::objectValue);
+    for (const auto &t : tables) {
+        entries[t.first] = static_cast<Json::UInt64>(t.second.entries.size());
+    }
+    ret["entries"] = entries;
+    return ret;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <json/json.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Finished responses of read handlers, keyed by table and by route plus
+// normalized query. Every write to a table drops that table's entries and
+// bumps its version; a handler reads the version before querying and passes
+// it to store(), so an answer that raced a write is never kept. Versions
+// only ever grow, invalidateAll() included, so they also tell clients apart
+// that saw the same table before and after a write (see ResultCachePlugin::etag).
+class ResultCache {
+ public:
+    struct Entry {
+        int status{200};
+        std::string contentType;
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> headers;
+    };
+
+    // per table, stores beyond this are dropped until the next invalidation
+    explicit ResultCache(size_t maxEntries);
+
+    auto find(const std::string &table, const std::string &key, Entry &entry) -> bool;
+    auto version(const std::string &table) const -> uint64_t;
+    void store(const std::string &table, const std::string &key, uint64_t version, Entry entry);
+    void invalidate(const std::string &table);
+    void invalidateAll();
+    // hits, misses, invalidations and entries held
+    auto stats() const -> Json::Value;
+
+ private:
+    struct Table {
+        uint64_t version{0};
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    auto versionOf(const Table &table) const -> uint64_t;
+
+    size_t maxEntries;
+    // guards everything below
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Table> tables;
+    // hands out versions; every table is at least at baseline, the version
+    // of the last invalidateAll()
+    uint64_t clock{0};
+    uint64_t baseline{0};
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t invalidations{0};
+};
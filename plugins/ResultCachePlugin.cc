@@ -0,0 +1,161 @@
+#include "ResultCachePlugin.h"
+#include <drogon/drogon.h>
+#include "../utils/utils.h"
+#include <libpq-fe.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstdio>
+#include <functional>
+#include <random>
+
+using namespace drogon;
+
+void ResultCachePlugin::initAndStart(const Json::Value &config) {
+    LOG_DEBUG << "ResultCache initialized and Start";
+    cache = std::make_unique<ResultCache>(config.get("max_entries", 10000).asUInt());
+    connection = config.get("connection", "").asString();
+    channel = config.get("channel", channel).asString();
+    std::random_device random;
+    instance = (static_cast<uint64_t>(random()) << 32) ^ random() ^
+               static_cast<uint64_t>(trantor::Date::now().microSecondsSinceEpoch());
+    if (connection.empty()) {
+        LOG_WARN << "ResultCache: no connection to listen on, caching disabled";
+        return;
+    }
+    running = true;
+    listener = std::thread([this]() { listen(); });
+}
+
+void ResultCachePlugin::shutdown() {
+    LOG_DEBUG << "ResultCache shut down";
+    running = false;
+    retry.notify_all();
+    if (listener.joinable()) {
+        listener.join();
+    }
+}
+
+auto ResultCachePlugin::find(const std::string &table, const std::string &key) -> HttpResponsePtr {
+    ResultCache::Entry entry;
+    if (!listening || !cache->find(table, key, entry)) {
+        return nullptr;
+    }
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(static_cast<HttpStatusCode>(entry.status));
+    resp->setContentTypeCodeAndCustomString(CT_CUSTOM, entry.contentType);
+    resp->setBody(std::move(entry.body));
+    for (const auto &header : entry.headers) {
+        resp->addHeader(header.first, header.second);
+    }
+    return resp;
+}
+
+auto ResultCachePlugin::version(const std::string &table) const -> uint64_t {
+    return cache ? cache->version(table) : 0;
+}
+
+void ResultCachePlugin::store(const std::string &table, const std::string &key, uint64_t version, const HttpResponsePtr &resp) {
+    if (!listening || resp->statusCode() >= k300MultipleChoices) {
+        return;
+    }
+    ResultCache::Entry entry;
+    entry.status = resp->statusCode();
+    entry.contentType = resp->contentTypeString();
+    entry.body = std::string(resp->body());
+    for (const auto &header : resp->headers()) {
+        entry.headers.emplace_back(header.first, header.second);
+    }
+    cache->store(table, key, version, std::move(entry));
+}
+
+void ResultCachePlugin::invalidate(const std::string &table) {
+    if (cache) {
+        cache->invalidate(table);
+    }
+}
+
+auto ResultCachePlugin::stats() const -> Json::Value {
+    if (!cache) {
+        return Json::Value();
+    }
+    auto ret = cache->stats();
+    ret["listening"] = listening.load();
+    return ret;
+}
+
+auto ResultCachePlugin::etag(std::initializer_list<const char *> tables, const std::string &key) const -> std::string {
+    if (!listening) {
+        return {};
+    }
+    auto text = key;
+    for (const auto *table : tables) {
+        text += ' ';
+        text += table;
+        text += '@';
+        text += std::to_string(cache->version(table));
+    }
+    char tag[40];
+    snprintf(tag, sizeof(tag), "\"%016llx-%016llx\"", static_cast<unsigned long long>(instance),
+             static_cast<unsigned long long>(std::hash<std::string>()(text)));
+    return tag;
+}
+
+auto ResultCachePlugin::notModified(const HttpRequestPtr &req, const std::string &etag) -> HttpResponsePtr {
+    if (etag.empty() || !etagMatches(req->getHeader("if-none-match"), etag)) {
+        return nullptr;
+    }
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(k304NotModified);
+    resp->addHeader("ETag", etag);
+    return resp;
+}
+
+void ResultCachePlugin::listen() {
+    while (running) {
+        auto *conn = PQconnectdb(connection.c_str());
+        if (PQstatus(conn) != CONNECTION_OK) {
+            LOG_ERROR << "ResultCache: cannot connect: " << PQerrorMessage(conn);
+            PQfinish(conn);
+            waitBeforeRetry();
+            continue;
+        }
+
+        auto *identifier = PQescapeIdentifier(conn, channel.c_str(), channel.size());
+        auto *res = PQexec(conn, (std::string("listen ") + identifier).c_str());
+        PQfreemem(identifier);
+        auto ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+        if (!ok) {
+            LOG_ERROR << "ResultCache: cannot listen: " << PQerrorMessage(conn);
+            PQfinish(conn);
+            waitBeforeRetry();
+            continue;
+        }
+
+        // whatever was written while nobody listened is unknown
+        cache->invalidateAll();
+        listening = true;
+        LOG_DEBUG << "ResultCache: listening on " << channel;
+        while (running) {
+            pollfd fd{PQsocket(conn), POLLIN, 0};
+            if ((poll(&fd, 1, 1000) < 0 && errno != EINTR) || !PQconsumeInput(conn)) {
+                LOG_ERROR << "ResultCache: lost connection: " << PQerrorMessage(conn);
+                break;
+            }
+            while (auto *notify = PQnotifies(conn)) {
+                cache->invalidate(notify->extra);
+                PQfreemem(notify);
+            }
+        }
+        listening = false;
+        PQfinish(conn);
+        if (running) {
+            waitBeforeRetry();
+        }
+    }
+}
+
+void ResultCachePlugin::waitBeforeRetry() {
+    std::unique_lock<std::mutex> lock(retryMutex);
+    retry.wait_for(lock, std::chrono::seconds(5), [this]() { return !running; });
+}
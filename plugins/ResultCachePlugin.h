@@ -0,0 +1,59 @@
+#pragma once
+
+#include <drogon/plugins/Plugin.h>
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <atomic>
+#include <condition_variable>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ResultCache.h"
+
+// Serves repeated reads of the small, rarely written tables from memory.
+// Handlers drop a table's entries right after their own writes; writes made
+// by other processes arrive as notifications on `channel`, which the
+// triggers in scripts/create_db.sql send with the table name as payload.
+// While the listening connection is down nothing is cached at all.
+class ResultCachePlugin : public drogon::Plugin<ResultCachePlugin> {
+ public:
+    virtual void initAndStart(const Json::Value &config) override;
+    virtual void shutdown() override;
+
+    // a fresh copy of the response cached under key, nullptr on a miss
+    auto find(const std::string &table, const std::string &key) -> drogon::HttpResponsePtr;
+    // read before querying and handed back to store()
+    auto version(const std::string &table) const -> uint64_t;
+    // keeps a successful resp unless table was written since version; only
+    // for answers read from the primary (DbRouterPlugin::reader with
+    // cacheable), a replica's could predate version
+    void store(const std::string &table, const std::string &key, uint64_t version, const drogon::HttpResponsePtr &resp);
+    void invalidate(const std::string &table);
+    auto stats() const -> Json::Value;
+
+    // Strong ETag for what a read of key, which depends on tables, answers
+    // right now. Read it before querying, as with version(). Empty while not
+    // listening: a write by another process could then go unnoticed. Like
+    // store(), only to be sent with an answer read from the primary.
+    auto etag(std::initializer_list<const char *> tables, const std::string &key) const -> std::string;
+    // a 304 carrying etag if req's If-None-Match already names it, else nullptr
+    static auto notModified(const drogon::HttpRequestPtr &req, const std::string &etag) -> drogon::HttpResponsePtr;
+
+ private:
+    void listen();
+    void waitBeforeRetry();
+
+    std::unique_ptr<ResultCache> cache;
+    std::string connection;
+    std::string channel{"org_chart_changes"};
+    // tells this process's tags from another's, or from its own before a restart
+    uint64_t instance{0};
+    // false until notifications can be trusted to arrive
+    std::atomic<bool> listening{false};
+    std::atomic<bool> running{false};
+    std::thread listener;
+    std::mutex retryMutex;
+    std::condition_variable retry;
+};
@@ -27,3 +27,21 @@ CREATE TABLE users (
     username VARCHAR(50) UNIQUE NOT NULL,
     password VARCHAR UNIQUE NOT NULL
 );
+
+-- tells every running instance which table changed, so they can drop what
+-- they cached from it
+CREATE FUNCTION notify_table_change() RETURNS trigger AS $$
+BEGIN
+    PERFORM pg_notify('org_chart_changes', TG_TABLE_NAME);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER job_changed AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON job
+    FOR EACH STATEMENT EXECUTE PROCEDURE notify_table_change();
+
+CREATE TRIGGER department_changed AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON department
+    FOR EACH STATEMENT EXECUTE PROCEDURE notify_table_change();
+
+CREATE TRIGGER person_changed AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON person
+    FOR EACH STATEMENT EXECUTE PROCEDURE notify_table_change();
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include "../plugins/DbPool.h"
+
+TEST(PoolSizerTest, GrowsWhileQueriesWaitUpToTheMaximum) {
+    PoolSizer sizer(1, 3, 0.02, 5);
+    EXPECT_EQ(sizer.observe(0.001, 1), 0);
+    EXPECT_EQ(sizer.observe(0.5, 1), 1);
+    EXPECT_EQ(sizer.observe(0.5, 2), 1);
+    EXPECT_EQ(sizer.observe(0.5, 3), 0);
+}
+
+TEST(PoolSizerTest, ShrinksAfterStayingCalmDownToTheMinimum) {
+    PoolSizer sizer(1, 3, 0.02, 3);
+    EXPECT_EQ(sizer.observe(0.1, 3), 0);
+    // the average has to decay below a quarter of grow_wait first
+    int calls = 0;
+    int resize;
+    while ((resize = sizer.observe(0, 3)) == 0) {
+        ASSERT_LT(++calls, 20);
+    }
+    EXPECT_EQ(resize, -1);
+    EXPECT_LT(sizer.averageWait(), 0.005);
+    EXPECT_EQ(sizer.observe(0, 2), 0);
+    EXPECT_EQ(sizer.observe(0, 2), 0);
+    EXPECT_EQ(sizer.observe(0, 2), -1);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(sizer.observe(0, 1), 0);
+    }
+}
+
+TEST(PoolSizerTest, ABusySampleResetsTheCalmStreak) {
+    PoolSizer sizer(1, 2, 0.02, 3);
+    EXPECT_EQ(sizer.observe(0, 2), 0);
+    EXPECT_EQ(sizer.observe(0, 2), 0);
+    EXPECT_EQ(sizer.observe(0.02, 2), 0);
+    EXPECT_EQ(sizer.observe(0, 2), 0);
+    EXPECT_EQ(sizer.observe(0, 2), 0);
+    EXPECT_EQ(sizer.observe(0, 2), -1);
+}
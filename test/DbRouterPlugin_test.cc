@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include "../plugins/DbRouterPlugin.h"
+#include "../plugins/ResultCache.h"
+
+TEST(DbRouterPluginTest, CacheableReadsGoToThePrimary) {
+    EXPECT_TRUE(DbRouterPlugin::readsPrimary(true, true, false));
+    EXPECT_FALSE(DbRouterPlugin::readsPrimary(true, false, false));
+    EXPECT_TRUE(DbRouterPlugin::readsPrimary(true, false, true));
+    EXPECT_TRUE(DbRouterPlugin::readsPrimary(false, false, false));
+}
+
+TEST(DbRouterPluginTest, ReplicaRoutedReadsHitTheCacheAfterTheFirstFill) {
+    // with replicas configured, a caller that has not written lately
+    ASSERT_FALSE(DbRouterPlugin::readsPrimary(true, false, false));
+
+    ResultCache cache(10);
+    ResultCache::Entry entry;
+    auto version = cache.version("department");
+    ASSERT_FALSE(cache.find("department", "id 1", entry));
+    // its miss is filled from the primary all the same, so it may be kept
+    ASSERT_TRUE(DbRouterPlugin::readsPrimary(true, true, false));
+    entry.body = "{\"id\":1}";
+    cache.store("department", "id 1", version, entry);
+
+    for (int i = 0; i < 3; ++i) {
+        ResultCache::Entry hit;
+        ASSERT_TRUE(cache.find("department", "id 1", hit));
+        EXPECT_EQ(hit.body, "{\"id\":1}");
+    }
+    EXPECT_EQ(cache.stats()["hits"].asUInt64(), 3u);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../plugins/HeadcountIndex.h"
+
+using namespace drogon_model::org_chart;
+
+namespace {
+
+Person makePerson(int32_t id, int32_t managerId) {
+    Person p;
+    p.setId(id);
+    p.setManagerId(managerId);
+    return p;
+}
+
+std::shared_ptr<const OrgGraph> seedGraph() {
+    return std::make_shared<const OrgGraph>(std::vector<Person>{
+        makePerson(1, 1), makePerson(2, 1), makePerson(3, 1), makePerson(4, 2),
+        makePerson(5, 2), makePerson(6, 3), makePerson(7, 3), makePerson(8, 1),
+        makePerson(9, 8), makePerson(10, 8), makePerson(11, 8), makePerson(12, 8),
+    });
+}
+
+// headcounts recomputed from scratch, person id -> manager id
+std::map<int32_t, int64_t> bruteForce(const std::map<int32_t, int32_t> &managers) {
+    std::map<int32_t, int64_t> counts;
+    for (const auto &m : managers) {
+        counts[m.first];
+        auto cur = m.second;
+        while (cur != m.first && managers.count(cur) > 0) {
+            ++counts[cur];
+            if (managers.at(cur) == cur) {
+                break;
+            }
+            cur = managers.at(cur);
+        }
+    }
+    return counts;
+}
+
+}  // namespace
+
+TEST(HeadcountIndexTest, SnapshotCounts) {
+    HeadcountIndex index(seedGraph());
+    EXPECT_EQ(index.headcount(1), 11);
+    EXPECT_EQ(index.headcount(8), 4);
+    EXPECT_EQ(index.headcount(12), 0);
+    EXPECT_EQ(index.headcount(42), -1);
+}
+
+TEST(HeadcountIndexTest, CreateAndDelete) {
+    HeadcountIndex index(seedGraph());
+    index.upsert(13, 12);
+    index.upsert(14, 13);
+    EXPECT_EQ(index.headcount(14), 0);
+    EXPECT_EQ(index.headcount(13), 1);
+    EXPECT_EQ(index.headcount(12), 2);
+    EXPECT_EQ(index.headcount(8), 6);
+    EXPECT_EQ(index.headcount(1), 13);
+    EXPECT_EQ(index.headcount(2), 2);
+
+    index.erase(14);
+    index.erase(5);
+    EXPECT_EQ(index.headcount(14), -1);
+    EXPECT_EQ(index.headcount(5), -1);
+    EXPECT_EQ(index.headcount(2), 1);
+    EXPECT_EQ(index.headcount(1), 11);
+}
+
+TEST(HeadcountIndexTest, ManagerChangeMovesWholeTeam) {
+    HeadcountIndex index(seedGraph());
+    index.upsert(8, 2);
+    EXPECT_EQ(index.headcount(2), 7);
+    EXPECT_EQ(index.headcount(1), 11);
+
+    // later changes inside the moved team follow it to its new manager
+    index.upsert(13, 9);
+    EXPECT_EQ(index.headcount(9), 1);
+    EXPECT_EQ(index.headcount(8), 5);
+    EXPECT_EQ(index.headcount(2), 8);
+    EXPECT_EQ(index.headcount(3), 2);
+    EXPECT_EQ(index.headcount(1), 12);
+}
+
+TEST(HeadcountIndexTest, SkipsMovedTeamsBesideThePath) {
+    HeadcountIndex index(seedGraph());
+    // three moved teams that all precede 10 in preorder without containing it
+    index.upsert(4, 3);
+    index.upsert(6, 8);
+    index.upsert(9, 2);
+    index.upsert(13, 10);
+    index.upsert(14, 6);
+
+    std::map<int32_t, int32_t> managers{{1, 1}, {2, 1}, {3, 1}, {4, 3}, {5, 2}, {6, 8}, {7, 3},
+                                        {8, 1}, {9, 2}, {10, 8}, {11, 8}, {12, 8}, {13, 10}, {14, 6}};
+    for (const auto &expected : bruteForce(managers)) {
+        EXPECT_EQ(index.headcount(expected.first), expected.second) << "person " << expected.first;
+    }
+}
+
+TEST(HeadcountIndexTest, MatchesRecomputationUnderRandomEdits) {
+    std::mt19937 rng(7);
+    std::map<int32_t, int32_t> managers{{1, 1}};
+    std::vector<Person> persons{makePerson(1, 1)};
+    for (int32_t id = 2; id <= 200; ++id) {
+        auto manager = std::uniform_int_distribution<int32_t>(1, id - 1)(rng);
+        managers[id] = manager;
+        persons.push_back(makePerson(id, manager));
+    }
+    HeadcountIndex index(std::make_shared<const OrgGraph>(std::move(persons)));
+
+    auto isUnder = [&](int32_t person, int32_t manager) {
+        for (auto cur = person; managers.at(cur) != cur;) {
+            cur = managers.at(cur);
+            if (cur == manager) {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto pick = [&]() {
+        auto it = managers.begin();
+        std::advance(it, std::uniform_int_distribution<size_t>(0, managers.size() - 1)(rng));
+        return it->first;
+    };
+
+    int32_t nextId = 201;
+    for (int step = 0; step < 2000; ++step) {
+        auto op = std::uniform_int_distribution<int>(0, 2)(rng);
+        if (op == 0) {
+            auto manager = pick();
+            managers[nextId] = manager;
+            index.upsert(nextId++, manager);
+        } else if (op == 1) {
+            auto person = pick();
+            auto manager = pick();
+            if (person == 1 || person == manager || isUnder(manager, person)) {
+                continue;
+            }
+            managers[person] = manager;
+            index.upsert(person, manager);
+        } else {
+            auto person = pick();
+            auto hasReports = false;
+            for (const auto &m : managers) {
+                hasReports |= m.second == person && m.first != person;
+            }
+            if (person == 1 || hasReports) {
+                continue;
+            }
+            managers.erase(person);
+            index.erase(person);
+        }
+        if (step % 50 == 0) {
+            for (const auto &expected : bruteForce(managers)) {
+                ASSERT_EQ(index.headcount(expected.first), expected.second) << "step " << step << " person " << expected.first;
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <drogon/orm/Exception.h>
+#include <drogon/orm/Result.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../third_party/drogon/orm_lib/src/ResultImpl.h"
+
+// A query result held in memory, so code reading rows can be exercised
+// without a database. Fields are text, as libpq hands them over; a nullptr
+// field is sql null.
+class InMemoryResult : public drogon::orm::ResultImpl {
+ public:
+    using Rows = std::vector<std::vector<const char *>>;
+
+    static auto make(std::vector<std::string> columnNames, Rows rows) -> drogon::orm::Result {
+        return drogon::orm::Result(std::make_shared<InMemoryResult>(std::move(columnNames), std::move(rows)));
+    }
+
+    InMemoryResult(std::vector<std::string> columnNames, Rows rows)
+      : names{std::move(columnNames)}, values{std::move(rows)} {}
+
+    auto size() const noexcept -> SizeType override {
+        return values.size();
+    }
+    auto columns() const noexcept -> RowSizeType override {
+        return static_cast<RowSizeType>(names.size());
+    }
+    auto columnName(RowSizeType number) const -> const char * override {
+        return names.at(number).c_str();
+    }
+    auto affectedRows() const noexcept -> SizeType override {
+        return 0;
+    }
+    auto columnNumber(const char colName[]) const -> RowSizeType override {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == colName) {
+                return static_cast<RowSizeType>(i);
+            }
+        }
+        throw drogon::orm::RangeError(std::string("there is no column named ") + colName);
+    }
+    auto getValue(SizeType row, RowSizeType column) const -> const char * override {
+        const auto *value = values[row][column];
+        return value ? value : "";
+    }
+    auto isNull(SizeType row, RowSizeType column) const -> bool override {
+        return values[row][column] == nullptr;
+    }
+    auto getLength(SizeType row, RowSizeType column) const -> FieldSizeType override {
+        return std::strlen(getValue(row, column));
+    }
+
+ private:
+    std::vector<std::string> names;
+    Rows values;
+};
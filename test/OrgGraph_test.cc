@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "../plugins/OrgGraph.h"
+
+using namespace drogon_model::org_chart;
+
+namespace {
+
+Person makePerson(int32_t id, int32_t managerId) {
+    Person p;
+    p.setId(id);
+    p.setManagerId(managerId);
+    return p;
+}
+
+// same shape as scripts/seed_db.sql, shuffled
+OrgGraph seedGraph() {
+    return OrgGraph({
+        makePerson(4, 2), makePerson(1, 1), makePerson(12, 8), makePerson(2, 1),
+        makePerson(3, 1), makePerson(5, 2), makePerson(6, 3), makePerson(7, 3),
+        makePerson(8, 1), makePerson(9, 8), makePerson(10, 8), makePerson(11, 8),
+    });
+}
+
+std::vector<int32_t> reportIds(const OrgGraph &graph, int32_t personId) {
+    std::vector<int32_t> ids;
+    auto range = graph.directReports(graph.indexOf(personId));
+    for (auto it = range.first; it != range.second; ++it) {
+        ids.push_back(graph.person(*it).getValueOfId());
+    }
+    return ids;
+}
+
+}  // namespace
+
+TEST(OrgGraphTest, IndexesPersonsById) {
+    auto graph = seedGraph();
+    EXPECT_EQ(graph.size(), 12u);
+    EXPECT_EQ(graph.indexOf(1), 0u);
+    EXPECT_EQ(graph.person(graph.indexOf(9)).getValueOfId(), 9);
+    EXPECT_EQ(graph.indexOf(13), OrgGraph::npos);
+}
+
+TEST(OrgGraphTest, SelfManagedPersonIsRoot) {
+    auto graph = seedGraph();
+    EXPECT_EQ(graph.manager(graph.indexOf(1)), OrgGraph::npos);
+    EXPECT_EQ(graph.manager(graph.indexOf(5)), graph.indexOf(2));
+}
+
+TEST(OrgGraphTest, DirectReports) {
+    auto graph = seedGraph();
+    EXPECT_EQ(reportIds(graph, 1), (std::vector<int32_t>{2, 3, 8}));
+    EXPECT_EQ(reportIds(graph, 8), (std::vector<int32_t>{9, 10, 11, 12}));
+    EXPECT_TRUE(reportIds(graph, 12).empty());
+}
+
+TEST(OrgGraphTest, UnknownManagerIsRoot) {
+    OrgGraph graph({makePerson(1, 1), makePerson(2, 42)});
+    EXPECT_EQ(graph.manager(graph.indexOf(2)), OrgGraph::npos);
+    EXPECT_TRUE(reportIds(graph, 1).empty());
+}
+
+TEST(OrgGraphTest, SubtreeIsBreadthFirstAndDepthLimited) {
+    auto graph = seedGraph();
+    std::vector<std::pair<int32_t, int>> all;
+    for (const auto &node : graph.subtree(graph.indexOf(1), 100)) {
+        all.emplace_back(graph.person(node.first).getValueOfId(), node.second);
+    }
+    ASSERT_EQ(all.size(), 12u);
+    EXPECT_EQ(all[0], std::make_pair(1, 0));
+    EXPECT_EQ(all[3], std::make_pair(8, 1));
+    EXPECT_EQ(all[4], std::make_pair(4, 2));
+    EXPECT_EQ(all[11], std::make_pair(12, 2));
+
+    EXPECT_EQ(graph.subtree(graph.indexOf(1), 1).size(), 4u);
+    EXPECT_EQ(graph.subtree(graph.indexOf(8), 0).size(), 1u);
+}
+
+TEST(OrgGraphTest, ManagerCyclesAreBroken) {
+    OrgGraph graph({makePerson(1, 3), makePerson(2, 1), makePerson(3, 2), makePerson(4, 3)});
+    std::vector<OrgGraph::Index> roots;
+    for (OrgGraph::Index i = 0; i < graph.size(); ++i) {
+        if (graph.manager(i) == OrgGraph::npos) {
+            roots.push_back(i);
+        }
+    }
+    ASSERT_EQ(roots.size(), 1u);
+    EXPECT_EQ(graph.subtree(roots[0], 100).size(), 4u);
+}
+
+TEST(OrgGraphTest, AncestorJumps) {
+    auto graph = seedGraph();
+    auto twelve = graph.indexOf(12);
+    EXPECT_EQ(graph.depth(twelve), 2u);
+    EXPECT_EQ(graph.ancestor(twelve, 0), twelve);
+    EXPECT_EQ(graph.ancestor(twelve, 1), graph.indexOf(8));
+    EXPECT_EQ(graph.ancestor(twelve, 2), graph.indexOf(1));
+    EXPECT_EQ(graph.ancestor(twelve, 3), OrgGraph::npos);
+}
+
+TEST(OrgGraphTest, AncestorJumpsOnDeepChain) {
+    std::vector<Person> persons{makePerson(1, 1)};
+    for (int32_t id = 2; id <= 1000; ++id) {
+        persons.push_back(makePerson(id, id - 1));
+    }
+    OrgGraph graph(std::move(persons));
+    auto last = graph.indexOf(1000);
+    EXPECT_EQ(graph.depth(last), 999u);
+    for (uint32_t k : {1u, 2u, 7u, 64u, 500u, 999u}) {
+        EXPECT_EQ(graph.person(graph.ancestor(last, k)).getValueOfId(), 1000 - static_cast<int32_t>(k));
+    }
+    EXPECT_EQ(graph.chain(last, 3).size(), 4u);
+    EXPECT_EQ(graph.chain(last, 5000).size(), 1000u);
+}
+
+TEST(OrgGraphTest, CommonManager) {
+    auto graph = seedGraph();
+    auto idOf = [&](int32_t a, int32_t b) {
+        auto m = graph.commonManager(graph.indexOf(a), graph.indexOf(b));
+        return m == OrgGraph::npos ? -1 : graph.person(m).getValueOfId();
+    };
+    EXPECT_EQ(idOf(4, 5), 2);
+    EXPECT_EQ(idOf(4, 7), 1);
+    EXPECT_EQ(idOf(12, 9), 8);
+    EXPECT_EQ(idOf(8, 12), 8);
+    EXPECT_EQ(idOf(6, 6), 6);
+    EXPECT_EQ(idOf(1, 11), 1);
+}
+
+TEST(OrgGraphTest, CommonManagerAcrossTrees) {
+    OrgGraph graph({makePerson(1, 1), makePerson(2, 1), makePerson(3, 3), makePerson(4, 3)});
+    EXPECT_EQ(graph.commonManager(graph.indexOf(2), graph.indexOf(4)), OrgGraph::npos);
+    EXPECT_EQ(graph.commonManager(graph.indexOf(4), graph.indexOf(3)), graph.indexOf(3));
+}
+
+TEST(OrgGraphTest, CommonManagerMatchesChainWalk) {
+    // wide and deep enough to exercise several sparse table levels
+    std::vector<Person> persons{makePerson(1, 1)};
+    for (int32_t id = 2; id <= 500; ++id) {
+        persons.push_back(makePerson(id, id / 3 + 1));
+    }
+    OrgGraph graph(std::move(persons));
+    for (int32_t a = 1; a <= 500; a += 7) {
+        for (int32_t b = 1; b <= 500; b += 11) {
+            auto ca = graph.chain(graph.indexOf(a), 1000);
+            auto cb = graph.chain(graph.indexOf(b), 1000);
+            OrgGraph::Index expected = OrgGraph::npos;
+            for (auto x : ca) {
+                if (std::find(cb.begin(), cb.end(), x) != cb.end()) {
+                    expected = x;
+                    break;
+                }
+            }
+            EXPECT_EQ(graph.commonManager(graph.indexOf(a), graph.indexOf(b)), expected) << a << " " << b;
+        }
+    }
+}
+
+TEST(OrgGraphTest, IsUnder) {
+    auto graph = seedGraph();
+    auto isUnder = [&](int32_t a, int32_t m) { return graph.isUnder(graph.indexOf(a), graph.indexOf(m)); };
+    EXPECT_TRUE(isUnder(12, 8));
+    EXPECT_TRUE(isUnder(12, 1));
+    EXPECT_TRUE(isUnder(7, 3));
+    EXPECT_FALSE(isUnder(7, 2));
+    EXPECT_FALSE(isUnder(8, 12));
+    EXPECT_FALSE(isUnder(8, 8));
+}
+
+TEST(OrgGraphTest, IsUnderAcrossTrees) {
+    OrgGraph graph({makePerson(1, 1), makePerson(2, 1), makePerson(3, 3), makePerson(4, 3)});
+    EXPECT_TRUE(graph.isUnder(graph.indexOf(4), graph.indexOf(3)));
+    EXPECT_FALSE(graph.isUnder(graph.indexOf(4), graph.indexOf(1)));
+    EXPECT_FALSE(graph.isUnder(graph.indexOf(2), graph.indexOf(3)));
+}
@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "InMemoryResult.h"
+#include "../models/PersonInfo.h"
+
+using namespace drogon_model::org_chart;
+
+TEST(PersonInfoTest, BoundColumnsReadTheSameRowInAnyOrder) {
+    std::vector<std::string> names = {"id",        "job_id",    "department_id", "manager_id",      "first_name",
+                                      "last_name", "hire_date", "job_title",     "department_name", "manager_full_name"};
+    InMemoryResult::Rows rows{{"8", "2", "3", nullptr, "Grace", "Hopper", "1906-12-09", "Admiral", "Navy", nullptr}};
+    auto inListOrder = InMemoryResult::make(names, rows);
+    std::reverse(names.begin(), names.end());
+    std::reverse(rows[0].begin(), rows[0].end());
+    names.push_back("level");
+    rows[0].push_back("2");
+    auto reordered = InMemoryResult::make(names, rows);
+
+    PersonInfo byOffset{inListOrder[0]};
+    PersonInfo bound{reordered[0], PersonInfo::columnsOf(reordered)};
+    EXPECT_EQ(bound.toJson(), byOffset.toJson());
+    EXPECT_EQ(bound.getValueOfLastName(), "Hopper");
+    EXPECT_EQ(bound.getManagerId(), nullptr);
+}
+
+TEST(PersonInfoTest, ColumnsOfRejectsResultsMissingAColumn) {
+    auto result = InMemoryResult::make(std::vector<std::string>{"id", "first_name", "last_name"}, {});
+    EXPECT_THROW(PersonInfo::columnsOf(result), drogon::orm::RangeError);
+}
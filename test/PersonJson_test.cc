@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "InMemoryResult.h"
+#include "../models/PersonInfo.h"
+#include "../utils/PersonJson.h"
+#include "../utils/utils.h"
+
+using namespace drogon_model::org_chart;
+
+namespace {
+const std::vector<std::string> listColumns = {"id",        "job_id",    "department_id", "manager_id",
+                                              "first_name", "last_name", "hire_date",     "job_title",
+                                              "department_name", "manager_full_name"};
+
+// the Json::Value PersonsController::PersonDetails builds for a row
+auto detailsJson(const PersonInfo &info, int64_t headcount) -> Json::Value {
+    Json::Value ret;
+    ret["id"] = info.getValueOfId();
+    ret["first_name"] = info.getValueOfFirstName();
+    ret["last_name"] = info.getValueOfLastName();
+    ret["hire_date"] = info.getValueOfHireDate().toDbStringLocal();
+    ret["manager"]["id"] = info.getValueOfManagerId();
+    ret["manager"]["full_name"] = info.getValueOfManagerFullName();
+    ret["department"]["id"] = info.getValueOfDepartmentId();
+    ret["department"]["name"] = info.getValueOfDepartmentName();
+    ret["job"]["id"] = info.getValueOfJobId();
+    ret["job"]["title"] = info.getValueOfJobTitle();
+    ret["headcount"] = headcount < 0 ? Json::Value() : Json::Value(static_cast<Json::Int64>(headcount));
+    return ret;
+}
+}  // namespace
+
+TEST(PersonJsonTest, WritesWhatPersonDetailsWrites) {
+    auto result = InMemoryResult::make(
+        listColumns,
+        {{"1", "2", "3", "1", "Ada", "Lovelace", "1843-07-01", "Engineer", "R&D", "Ada Lovelace"},
+         {"42", "7", "9", "1", "Zoë \"Z\"", "Ng\\Ō", "2020-02-29", "Chief \xf0\x9f\x98\x80 Officer", "Ops\n", "Ada Lovelace"},
+         {"5", "2", "3", nullptr, "No", nullptr, nullptr, "Engineer", "R&D", nullptr}});
+    const int64_t headcounts[] = {2, 0, -1};
+
+    PersonJsonWriter writer{result};
+    std::string body;
+    std::string expected;
+    for (size_t i = 0; i < result.size(); ++i) {
+        writer.appendElement(body, result[i], headcounts[i]);
+        appendJsonElement(expected, detailsJson(PersonInfo(result[i]), headcounts[i]));
+    }
+    EXPECT_EQ(body, expected);
+}
+
+TEST(PersonJsonTest, FindsColumnsByNameWhereverTheyAre) {
+    InMemoryResult::Rows row{{"8", "2", "3", "1", "Grace", "Hopper", "1906-12-09", "Admiral", "Navy", "Grace Hopper"}};
+    auto inListOrder = InMemoryResult::make(listColumns, row);
+
+    auto names = listColumns;
+    std::reverse(names.begin(), names.end());
+    std::reverse(row[0].begin(), row[0].end());
+    names.insert(names.begin(), "parent_exists");
+    row[0].insert(row[0].begin(), "t");
+    auto reordered = InMemoryResult::make(names, row);
+
+    std::string expected;
+    PersonJsonWriter{inListOrder}.appendElement(expected, inListOrder[0], 0);
+    std::string body;
+    PersonJsonWriter{reordered}.appendElement(body, reordered[0], 0);
+    EXPECT_EQ(body, expected);
+}
+
+TEST(PersonJsonTest, RejectsResultsMissingAColumn) {
+    auto result = InMemoryResult::make(std::vector<std::string>{"id", "first_name", "last_name"}, {});
+    EXPECT_THROW(PersonJsonWriter{result}, drogon::orm::RangeError);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../utils/RecordReader.h"
+
+namespace {
+
+struct Read {
+    size_t line;
+    Json::Value record;
+    std::string err;
+};
+
+std::vector<Read> readAll(const std::string &body, RecordReader::Format format) {
+    RecordReader reader(body, format);
+    std::vector<Read> ret;
+    Json::Value record;
+    std::string err;
+    while (reader.next(record, err)) {
+        ret.push_back({reader.line(), record, err});
+    }
+    return ret;
+}
+
+}  // namespace
+
+TEST(RecordReaderTest, CsvMapsColumnsByHeader) {
+    auto rows = readAll("first_name,last_name,job_id\r\nAnn,Lee,3\r\n\r\nBo,\"Smith, Jr.\",4\n",
+                        RecordReader::Format::csv);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0].line, 2u);
+    EXPECT_EQ(rows[0].record["first_name"].asString(), "Ann");
+    EXPECT_EQ(rows[0].record["job_id"].asString(), "3");
+    EXPECT_EQ(rows[1].line, 4u);
+    EXPECT_EQ(rows[1].record["last_name"].asString(), "Smith, Jr.");
+}
+
+TEST(RecordReaderTest, CsvQuotedFieldsSpanLines) {
+    auto rows = readAll("\xEF\xBB\xBF" "a,b\n\"say \"\"hi\"\"\",\"two\nlines\"\nx,y", RecordReader::Format::csv);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0].record["a"].asString(), "say \"hi\"");
+    EXPECT_EQ(rows[0].record["b"].asString(), "two\nlines");
+    EXPECT_EQ(rows[1].line, 4u);
+    EXPECT_EQ(rows[1].record["a"].asString(), "x");
+}
+
+TEST(RecordReaderTest, CsvReportsBadRows) {
+    auto rows = readAll("a,b\n1\n1,,\n1,\n", RecordReader::Format::csv);
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_FALSE(rows[0].err.empty());
+    EXPECT_FALSE(rows[1].err.empty());
+    EXPECT_TRUE(rows[2].err.empty());
+    EXPECT_FALSE(rows[2].record.isMember("b"));
+}
+
+TEST(RecordReaderTest, Ndjson) {
+    auto rows = readAll("{\"a\":1}\n\n[1]\n{oops\n{\"a\":2}", RecordReader::Format::ndjson);
+    ASSERT_EQ(rows.size(), 4u);
+    EXPECT_EQ(rows[0].record["a"].asInt(), 1);
+    EXPECT_EQ(rows[1].line, 3u);
+    EXPECT_FALSE(rows[1].err.empty());
+    EXPECT_FALSE(rows[2].err.empty());
+    EXPECT_EQ(rows[3].line, 5u);
+    EXPECT_EQ(rows[3].record["a"].asInt(), 2);
+}
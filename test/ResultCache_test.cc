@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "../plugins/ResultCache.h"
+
+namespace {
+auto entryWith(const std::string &body) -> ResultCache::Entry {
+    ResultCache::Entry entry;
+    entry.body = body;
+    return entry;
+}
+}  // namespace
+
+TEST(ResultCacheTest, ServesStoredEntriesAndCountsLookups) {
+    ResultCache cache(10);
+    ResultCache::Entry entry;
+    EXPECT_FALSE(cache.find("job", "id 1", entry));
+    cache.store("job", "id 1", cache.version("job"), entryWith("[1]"));
+    ASSERT_TRUE(cache.find("job", "id 1", entry));
+    EXPECT_EQ(entry.body, "[1]");
+    EXPECT_FALSE(cache.find("department", "id 1", entry));
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats["hits"].asUInt64(), 1u);
+    EXPECT_EQ(stats["misses"].asUInt64(), 2u);
+    EXPECT_EQ(stats["entries"]["job"].asUInt64(), 1u);
+}
+
+TEST(ResultCacheTest, InvalidationDropsOnlyThatTable) {
+    ResultCache cache(10);
+    cache.store("job", "id 1", cache.version("job"), entryWith("job"));
+    cache.store("department", "id 1", cache.version("department"), entryWith("department"));
+    cache.invalidate("job");
+
+    ResultCache::Entry entry;
+    EXPECT_FALSE(cache.find("job", "id 1", entry));
+    EXPECT_TRUE(cache.find("department", "id 1", entry));
+    cache.invalidateAll();
+    EXPECT_FALSE(cache.find("department", "id 1", entry));
+}
+
+TEST(ResultCacheTest, DropsAnswersThatRacedAWrite) {
+    ResultCache cache(10);
+    auto version = cache.version("job");
+    // the write lands while the read is still in flight
+    cache.invalidate("job");
+    cache.store("job", "list", version, entryWith("stale"));
+
+    ResultCache::Entry entry;
+    EXPECT_FALSE(cache.find("job", "list", entry));
+    cache.store("job", "list", cache.version("job"), entryWith("fresh"));
+    ASSERT_TRUE(cache.find("job", "list", entry));
+    EXPECT_EQ(entry.body, "fresh");
+}
+
+TEST(ResultCacheTest, StopsStoringWhenFull) {
+    ResultCache cache(1);
+    cache.store("job", "a", 0, entryWith("a"));
+    cache.store("job", "b", 0, entryWith("b"));
+
+    ResultCache::Entry entry;
+    EXPECT_TRUE(cache.find("job", "a", entry));
+    EXPECT_FALSE(cache.find("job", "b", entry));
+}
+
+TEST(ResultCacheTest, VersionsOnlyGrow) {
+    ResultCache cache(10);
+    auto person = cache.version("person");
+    auto job = cache.version("job");
+    cache.invalidate("job");
+    EXPECT_GT(cache.version("job"), job);
+    EXPECT_EQ(cache.version("person"), person);
+
+    // tables nobody has written yet move on with a reconnect as well
+    job = cache.version("job");
+    cache.invalidateAll();
+    EXPECT_GT(cache.version("person"), person);
+    EXPECT_GT(cache.version("job"), job);
+}
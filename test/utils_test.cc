@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "../utils/utils.h"
+
+TEST(PageCursorTest, RoundTrips) {
+    PageCursor cursor{"manager_full_name", "desc", "Ann \"Nan\" O'Neil", 4711};
+    auto token = encodeCursor(cursor);
+    EXPECT_EQ(token.find_first_of("+/="), std::string::npos);
+
+    PageCursor decoded;
+    ASSERT_TRUE(decodeCursor(token, decoded));
+    EXPECT_EQ(decoded.sortField, cursor.sortField);
+    EXPECT_EQ(decoded.sortOrder, cursor.sortOrder);
+    EXPECT_EQ(decoded.key, cursor.key);
+    EXPECT_EQ(decoded.id, cursor.id);
+}
+
+TEST(PageCursorTest, RejectsForeignTokens) {
+    PageCursor decoded;
+    EXPECT_FALSE(decodeCursor("", decoded));
+    EXPECT_FALSE(decodeCursor("not a cursor", decoded));
+    // valid base64 of valid JSON, but not a cursor
+    EXPECT_FALSE(decodeCursor("WzEsMl0", decoded));
+}
+
+TEST(PgArrayTest, QuotesAndEscapesElements) {
+    EXPECT_EQ(toPgArray({}), "{}");
+    EXPECT_EQ(toPgArray({"1", "2"}), "{\"1\",\"2\"}");
+    EXPECT_EQ(toPgArray({"a,b", "say \"hi\"", "back\\slash", ""}),
+              "{\"a,b\",\"say \\\"hi\\\"\",\"back\\\\slash\",\"\"}");
+}
+
+TEST(JsonStringTest, EscapesLikeJsoncpp) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    const std::string samples[] = {
+        "",
+        "plain text",
+        "say \"hi\" \\ bye",
+        std::string("\x01\x1f\b\f\n\r\t\x7f", 9),
+        "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80",
+        "\xc3",
+        "\xe2\x82",
+        "\xc0\x80 overlong",
+        "\xed\xa0\x80 surrogate",
+        "\xff stray",
+        std::string("nul\0inside", 10),
+    };
+    for (const auto &sample : samples) {
+        std::string body;
+        appendJsonString(body, sample);
+        EXPECT_EQ(body, Json::writeString(builder, Json::Value(sample))) << sample;
+    }
+}
+
+TEST(IdListTest, ParsesCommaSeparatedIds) {
+    std::vector<int32_t> ids;
+    ASSERT_TRUE(parseIdList("3,1,2", ids));
+    EXPECT_EQ(ids, (std::vector<int32_t>{3, 1, 2}));
+    ASSERT_TRUE(parseIdList("2147483647", ids));
+    EXPECT_EQ(ids, (std::vector<int32_t>{2147483647}));
+}
+
+TEST(IdListTest, RejectsAnythingElse) {
+    std::vector<int32_t> ids;
+    EXPECT_FALSE(parseIdList("", ids));
+    EXPECT_FALSE(parseIdList("1,,2", ids));
+    EXPECT_FALSE(parseIdList("1,", ids));
+    EXPECT_FALSE(parseIdList("1, 2", ids));
+    EXPECT_FALSE(parseIdList("-1", ids));
+    EXPECT_FALSE(parseIdList("0", ids));
+    EXPECT_FALSE(parseIdList("2147483648", ids));
+    EXPECT_FALSE(parseIdList("1;drop table person", ids));
+}
+
+TEST(CsvFieldTest, QuotesOnlyWhenNeeded) {
+    std::string line;
+    appendCsvField(line, "plain");
+    line += ',';
+    appendCsvField(line, "Smith, Jr.");
+    line += ',';
+    appendCsvField(line, "say \"hi\"");
+    EXPECT_EQ(line, "plain,\"Smith, Jr.\",\"say \"\"hi\"\"\"");
+}
+
+TEST(EtagTest, MatchesAnyListedTag) {
+    const std::string etag = "\"1f-2a\"";
+    EXPECT_TRUE(etagMatches("\"1f-2a\"", etag));
+    EXPECT_TRUE(etagMatches("\"00\", W/\"1f-2a\"", etag));
+    EXPECT_TRUE(etagMatches(" * ", etag));
+    EXPECT_FALSE(etagMatches("", etag));
+    EXPECT_FALSE(etagMatches("\"1f-2b\"", etag));
+    EXPECT_FALSE(etagMatches("1f-2a", etag));
+}
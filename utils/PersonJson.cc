@@ -0,0 +1,91 @@
+#include "PersonJson.h"
+#include "utils.h"
+#include <trantor/utils/Date.h>
+#include <cstring>
+#include <ctime>
+
+using namespace drogon::orm;
+using namespace drogon_model::org_chart;
+
+namespace {
+enum class Kind { integer, text, date, headcount };
+
+struct FieldSpec {
+    const char *prefix;
+    size_t prefixLength;
+    // slot in PersonInfo::Columns
+    size_t column;
+    Kind kind;
+};
+
+template <size_t N>
+constexpr auto field(const char (&prefix)[N], size_t column, Kind kind) -> FieldSpec {
+    return {prefix, N - 1, column, kind};
+}
+
+// in the order Json::Value writes PersonDetails::toJson, i.e. sorted keys;
+// each entry carries the text up to its value
+constexpr FieldSpec fields[] = {
+    field("{\"department\":{\"id\":", 2, Kind::integer),
+    field(",\"name\":", 8, Kind::text),
+    field("},\"first_name\":", 4, Kind::text),
+    field(",\"headcount\":", 0, Kind::headcount),
+    field(",\"hire_date\":", 6, Kind::date),
+    field(",\"id\":", 0, Kind::integer),
+    field(",\"job\":{\"id\":", 1, Kind::integer),
+    field(",\"title\":", 7, Kind::text),
+    field("},\"last_name\":", 5, Kind::text),
+    field(",\"manager\":{\"full_name\":", 9, Kind::text),
+    field(",\"id\":", 3, Kind::integer),
+};
+static_assert(sizeof(fields) / sizeof(fields[0]) == PersonJsonWriter::fieldCount, "fieldCount is the table size");
+
+// what PersonInfo and PersonDetails turn a date column into: midnight local
+// time, printed back in local time
+void appendDate(std::string &body, const Field &value) {
+    trantor::Date date;
+    if (!value.isNull()) {
+        struct tm stm;
+        memset(&stm, 0, sizeof(stm));
+        strptime(value.c_str(), "%Y-%m-%d", &stm);
+        date = trantor::Date(mktime(&stm) * 1000000);
+    }
+    body += '"';
+    body += date.toDbStringLocal();
+    body += '"';
+}
+}  // namespace
+
+PersonJsonWriter::PersonJsonWriter(const Result &result) : columns{PersonInfo::columnsOf(result)} {}
+
+void PersonJsonWriter::appendElement(std::string &body, const Row &row, int64_t headcount) const {
+    body += body.empty() ? '[' : ',';
+    for (size_t f = 0; f < fieldCount; ++f) {
+        body.append(fields[f].prefix, fields[f].prefixLength);
+        if (fields[f].kind == Kind::headcount) {
+            body += headcount < 0 ? "null" : std::to_string(headcount);
+            continue;
+        }
+
+        auto value = row[columns[fields[f].column]];
+        switch (fields[f].kind) {
+        case Kind::integer:
+            // postgres sends integers as plain decimal text already
+            if (value.isNull()) {
+                body += '0';
+            } else {
+                body.append(value.c_str(), value.length());
+            }
+            break;
+        case Kind::text:
+            appendJsonString(body, value.isNull() ? drogon::string_view() : drogon::string_view(value.c_str(), value.length()));
+            break;
+        case Kind::date:
+            appendDate(body, value);
+            break;
+        case Kind::headcount:
+            break;
+        }
+    }
+    body += "}}";
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <drogon/orm/Result.h>
+#include <drogon/orm/Row.h>
+#include <cstdint>
+#include <string>
+#include "../models/PersonInfo.h"
+
+// Writes rows of the /persons list query (person.*, job_title,
+// department_name, manager_full_name) as the same json PersonDetails
+// produces, straight from the row's text into a response body, without a
+// PersonInfo or Json::Value in between. Column positions are looked up once
+// per result, with PersonInfo::columnsOf.
+class PersonJsonWriter {
+ public:
+    static constexpr size_t fieldCount = 11;
+
+    explicit PersonJsonWriter(const drogon::orm::Result &result);
+
+    // appends row as the next element of a json array body, as
+    // appendJsonElement does; a negative headcount is written as null
+    void appendElement(std::string &body, const drogon::orm::Row &row, int64_t headcount) const;
+
+ private:
+    drogon_model::org_chart::PersonInfo::Columns columns;
+};
@@ -0,0 +1,135 @@
+#include "RecordReader.h"
+#include <algorithm>
+
+namespace {
+auto isBlank(drogon::string_view text) -> bool {
+    return text.find_first_not_of(" \t\r") == drogon::string_view::npos;
+}
+}  // namespace
+
+RecordReader::RecordReader(drogon::string_view body, Format format) : body{body}, format{format} {
+    // a byte order mark would otherwise end up in the first column name
+    if (this->body.substr(0, 3) == "\xEF\xBB\xBF") {
+        pos = 3;
+    }
+    if (format == Format::ndjson) {
+        jsonReader.reset(Json::CharReaderBuilder().newCharReader());
+    }
+}
+
+auto RecordReader::next(Json::Value &record, std::string &err) -> bool {
+    record = Json::Value(Json::objectValue);
+    err.clear();
+    if (format == Format::ndjson) {
+        return nextNdjsonLine(record, err);
+    }
+
+    std::vector<std::string> fields;
+    auto blank = [&fields] { return fields.size() == 1 && fields[0].empty(); };
+    while (header.empty()) {
+        if (!nextCsvRow(fields, err)) {
+            return false;
+        }
+        if (!err.empty()) {
+            return true;
+        }
+        if (!blank()) {
+            header = std::move(fields);
+        }
+    }
+    do {
+        if (!nextCsvRow(fields, err)) {
+            return false;
+        }
+    } while (err.empty() && blank());
+    if (!err.empty()) {
+        return true;
+    }
+    if (fields.size() != header.size()) {
+        err = "expected " + std::to_string(header.size()) + " fields, got " + std::to_string(fields.size());
+        return true;
+    }
+    // empty cells are left out, as if the column were missing
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (!fields[i].empty()) {
+            record[header[i]] = fields[i];
+        }
+    }
+    return true;
+}
+
+auto RecordReader::line() const -> size_t {
+    return recordLine;
+}
+
+// RFC 4180: quoted fields may hold commas, newlines and "" for a quote
+auto RecordReader::nextCsvRow(std::vector<std::string> &fields, std::string &err) -> bool {
+    if (pos >= body.size()) {
+        return false;
+    }
+    fields.clear();
+    recordLine = currentLine;
+    std::string field;
+    auto inQuotes = false;
+    while (pos < body.size()) {
+        auto c = body[pos++];
+        if (inQuotes) {
+            if (c != '"') {
+                currentLine += c == '\n';
+                field += c;
+            } else if (pos < body.size() && body[pos] == '"') {
+                field += '"';
+                ++pos;
+            } else {
+                inQuotes = false;
+            }
+            continue;
+        }
+        switch (c) {
+        case '"':
+            inQuotes = true;
+            break;
+        case ',':
+            fields.push_back(std::move(field));
+            field.clear();
+            break;
+        case '\r':
+            if (pos < body.size() && body[pos] == '\n') {
+                break;
+            }
+            field += c;
+            break;
+        case '\n':
+            ++currentLine;
+            fields.push_back(std::move(field));
+            return true;
+        default:
+            field += c;
+        }
+    }
+    if (inQuotes) {
+        err = "unterminated quoted field";
+    }
+    fields.push_back(std::move(field));
+    return true;
+}
+
+auto RecordReader::nextNdjsonLine(Json::Value &record, std::string &err) -> bool {
+    while (pos < body.size()) {
+        auto end = std::min(body.find('\n', pos), body.size());
+        auto text = body.substr(pos, end - pos);
+        pos = end + 1;
+        recordLine = currentLine++;
+        if (isBlank(text)) {
+            continue;
+        }
+        std::string errs;
+        if (!jsonReader->parse(text.data(), text.data() + text.size(), &record, &errs)) {
+            err = "invalid json: " + errs;
+        } else if (!record.isObject()) {
+            err = "expected a json object";
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <json/json.h>
+#include <drogon/utils/string_view.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Walks an uploaded CSV (header row first) or NDJSON body one record at a
+// time, turning each into a json object keyed by column name. The body is
+// only viewed, never copied: drogon keeps large bodies in a mapped temp file,
+// and only the current record is ever materialized.
+class RecordReader {
+ public:
+    enum class Format { csv, ndjson };
+
+    RecordReader(drogon::string_view body, Format format);
+
+    // false once the body is exhausted; otherwise either record holds the
+    // next row or err says why it could not be read
+    auto next(Json::Value &record, std::string &err) -> bool;
+    // line the last record started on, 1-based
+    auto line() const -> size_t;
+
+ private:
+    auto nextCsvRow(std::vector<std::string> &fields, std::string &err) -> bool;
+    auto nextNdjsonLine(Json::Value &record, std::string &err) -> bool;
+
+    drogon::string_view body;
+    Format format;
+    size_t pos{0};
+    size_t currentLine{1};
+    size_t recordLine{0};
+    std::vector<std::string> header;
+    std::unique_ptr<Json::CharReader> jsonReader;
+};
@@ -1,5 +1,18 @@
 #include "utils.h"
 #include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace {
+const Json::StreamWriterBuilder &compactWriter() {
+    static const Json::StreamWriterBuilder builder = [] {
+        Json::StreamWriterBuilder b;
+        b["indentation"] = "";
+        return b;
+    }();
+    return builder;
+}
+}  // namespace
 
 void badRequest(std::function<void(const drogon::HttpResponsePtr &)> &&callback, std::string err, drogon::HttpStatusCode code)
 {
@@ -15,3 +28,218 @@ Json::Value makeErrResp(std::string err) {
     ret["error"] = err;
     return ret;
 }
+
+void appendJsonElement(std::string &body, const Json::Value &element) {
+    body += body.empty() ? '[' : ',';
+    body += Json::writeString(compactWriter(), element);
+}
+
+void appendJsonLine(std::string &body, const Json::Value &element) {
+    body += Json::writeString(compactWriter(), element);
+    body += '\n';
+}
+
+void appendJsonString(std::string &body, drogon::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    auto appendHex = [&body](unsigned codepoint) {
+        const char escape[] = {'\\', 'u', hex[(codepoint >> 12) & 0xf], hex[(codepoint >> 8) & 0xf],
+                               hex[(codepoint >> 4) & 0xf], hex[codepoint & 0xf]};
+        body.append(escape, sizeof(escape));
+    };
+
+    body += '"';
+    const auto *p = text.data();
+    const auto *end = p + text.size();
+    while (p != end) {
+        // plain ASCII is copied in runs
+        const auto *run = p;
+        while (p != end && static_cast<unsigned char>(*p) >= 0x20 && static_cast<unsigned char>(*p) < 0x80 &&
+               *p != '"' && *p != '\\') {
+            ++p;
+        }
+        body.append(run, p - run);
+        if (p == end) {
+            break;
+        }
+
+        unsigned c = static_cast<unsigned char>(*p);
+        switch (c) {
+        case '"': body += "\\\""; break;
+        case '\\': body += "\\\\"; break;
+        case '\b': body += "\\b"; break;
+        case '\f': body += "\\f"; break;
+        case '\n': body += "\\n"; break;
+        case '\r': body += "\\r"; break;
+        case '\t': body += "\\t"; break;
+        default:
+            if (c < 0x80) {
+                appendHex(c);
+                break;
+            }
+            // decoded the way jsoncpp does, U+FFFD for anything malformed
+            unsigned codepoint = 0xfffd;
+            auto left = end - p;
+            if (c < 0xe0) {
+                if (left >= 2) {
+                    codepoint = ((c & 0x1f) << 6) | (p[1] & 0x3f);
+                    p += 1;
+                    codepoint = codepoint < 0x80 ? 0xfffd : codepoint;
+                }
+            } else if (c < 0xf0) {
+                if (left >= 3) {
+                    codepoint = ((c & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+                    p += 2;
+                    codepoint = codepoint < 0x800 || (codepoint >= 0xd800 && codepoint <= 0xdfff) ? 0xfffd : codepoint;
+                }
+            } else if (c < 0xf8) {
+                if (left >= 4) {
+                    codepoint = ((c & 0x07) << 18) | ((p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+                    p += 3;
+                    codepoint = codepoint < 0x10000 ? 0xfffd : codepoint;
+                }
+            }
+            if (codepoint < 0x10000) {
+                appendHex(codepoint);
+            } else {
+                codepoint -= 0x10000;
+                appendHex(0xd800 + ((codepoint >> 10) & 0x3ff));
+                appendHex(0xdc00 + (codepoint & 0x3ff));
+            }
+        }
+        ++p;
+    }
+    body += '"';
+}
+
+drogon::HttpResponsePtr newJsonArrayResponse(std::string &&body) {
+    body += body.empty() ? "[]" : "]";
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    resp->setBody(std::move(body));
+    return resp;
+}
+
+std::string encodeCursor(const PageCursor &cursor) {
+    Json::Value fields{Json::arrayValue};
+    fields.append(cursor.sortField);
+    fields.append(cursor.sortOrder);
+    fields.append(cursor.key);
+    fields.append(cursor.id);
+    auto body = Json::writeString(compactWriter(), fields);
+    auto token = drogon::utils::base64Encode(reinterpret_cast<const unsigned char *>(body.data()),
+                                             static_cast<unsigned int>(body.size()), true);
+    // padding would need escaping in a query string and decoding works without it
+    while (!token.empty() && token.back() == '=') {
+        token.pop_back();
+    }
+    return token;
+}
+
+bool decodeCursor(const std::string &token, PageCursor &cursor) {
+    auto body = drogon::utils::base64Decode(token);
+    Json::Value fields;
+    std::string errs;
+    static const Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    if (!reader->parse(body.data(), body.data() + body.size(), &fields, &errs)) {
+        return false;
+    }
+    if (!fields.isArray() || fields.size() != 4 || !fields[0].isString() || !fields[1].isString() ||
+        !fields[2].isString() || !fields[3].isInt()) {
+        return false;
+    }
+    cursor.sortField = fields[0].asString();
+    cursor.sortOrder = fields[1].asString();
+    cursor.key = fields[2].asString();
+    cursor.id = fields[3].asInt();
+    return true;
+}
+
+void addNextCursor(const drogon::HttpResponsePtr &resp, const PageCursor &cursor) {
+    resp->addHeader("Next-Cursor", encodeCursor(cursor));
+}
+
+std::string toPgArray(const std::vector<std::string> &elements) {
+    std::string ret = "{";
+    for (const auto &element : elements) {
+        if (ret.size() > 1) {
+            ret += ',';
+        }
+        ret += '"';
+        for (auto c : element) {
+            if (c == '"' || c == '\\') {
+                ret += '\\';
+            }
+            ret += c;
+        }
+        ret += '"';
+    }
+    ret += '}';
+    return ret;
+}
+
+bool parseIdList(const std::string &text, std::vector<int32_t> &ids) {
+    ids.clear();
+    int64_t id = 0;
+    size_t digits = 0;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        if (i == text.size() || text[i] == ',') {
+            if (digits == 0 || id == 0) {
+                return false;
+            }
+            ids.push_back(static_cast<int32_t>(id));
+            id = 0;
+            digits = 0;
+            continue;
+        }
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        id = id * 10 + (text[i] - '0');
+        if (id > std::numeric_limits<int32_t>::max()) {
+            return false;
+        }
+        ++digits;
+    }
+    return true;
+}
+
+bool etagMatches(drogon::string_view ifNoneMatch, const std::string &etag) {
+    size_t pos = 0;
+    while (pos < ifNoneMatch.size()) {
+        auto end = ifNoneMatch.find(',', pos);
+        if (end == drogon::string_view::npos) {
+            end = ifNoneMatch.size();
+        }
+        auto tag = ifNoneMatch.substr(pos, end - pos);
+        pos = end + 1;
+        while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t')) {
+            tag.remove_prefix(1);
+        }
+        while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t')) {
+            tag.remove_suffix(1);
+        }
+        if (tag.size() > 2 && tag[0] == 'W' && tag[1] == '/') {
+            tag.remove_prefix(2);
+        }
+        if (tag == "*" || tag == drogon::string_view(etag)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void appendCsvField(std::string &line, const std::string &field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        line += field;
+        return;
+    }
+    line += '"';
+    for (auto c : field) {
+        if (c == '"') {
+            line += '"';
+        }
+        line += c;
+    }
+    line += '"';
+}
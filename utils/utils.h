@@ -9,3 +9,43 @@ void badRequest (
 );
 
 Json::Value makeErrResp(std::string err);
+
+// Build a JSON array response one element at a time, so large listings are
+// never held as a single Json::Value tree.
+void appendJsonElement(std::string &body, const Json::Value &element);
+drogon::HttpResponsePtr newJsonArrayResponse(std::string &&body);
+// one compact json document per line, as in NDJSON
+void appendJsonLine(std::string &body, const Json::Value &element);
+// text as a quoted json string, escaped byte for byte like the writer above
+// (non-ASCII as \u escapes), without going through a Json::Value
+void appendJsonString(std::string &body, drogon::string_view text);
+
+// Where a keyset-paginated listing stopped: the sort it was read in and the
+// sort key and id of its last row. Clients only ever see it as an opaque,
+// url-safe token.
+struct PageCursor {
+    std::string sortField;
+    std::string sortOrder;
+    std::string key;
+    int32_t id{0};
+};
+
+std::string encodeCursor(const PageCursor &cursor);
+// false if token is not something encodeCursor produced
+bool decodeCursor(const std::string &token, PageCursor &cursor);
+// tells the client where the next page starts; only sent for full pages
+void addNextCursor(const drogon::HttpResponsePtr &resp, const PageCursor &cursor);
+
+// Postgres array literal of elements, for binding a whole list as a single
+// text parameter (e.g. $1::int[]); every element is quoted and escaped
+std::string toPgArray(const std::vector<std::string> &elements);
+
+// comma-separated positive ids, as in ids=1,2,3; false on anything else
+bool parseIdList(const std::string &text, std::vector<int32_t> &ids);
+
+// whether an If-None-Match header value names etag (or is *); weak tags
+// match their strong counterpart, as If-None-Match compares weakly
+bool etagMatches(drogon::string_view ifNoneMatch, const std::string &etag);
+
+// appends field to a CSV line, quoted if it holds a comma, quote or newline
+void appendCsvField(std::string &line, const std::string &field);